@@ -1,5 +1,7 @@
 #include "BasicSc2Bot.h"
 
+#include "s2clientprotocol/sc2api.pb.h"
+
 /*
 # Windows
 ./BasicSc2Bot.exe -c -a zerg -d Hard -m CactusValleyLE.SC2Map
@@ -10,14 +12,149 @@
 
 using namespace sc2;
 
+const char *const kBuildOrderFile = "BuildOrder.txt"; // Written by tools/BuildOrderOptimizer
+const int kBuildOrderStallSteps = 1344;               // Skip an opener item that could not start for a minute of game time
+const float kTechSaveSeconds = 6.0f;                  // Hold larva spending if the next tech is affordable this soon
+const float kDroneSpeed = 3.94f;                      // Game units per second, for expansion travel time
+const float kExpansionHoldSeconds = 10.0f;            // A drone sent ahead waits this long past its arrival for the hatchery money
+const float kCreepTumorEnergy = 25.0f;                // Queen energy for a tumor, on top of the energy kept for an inject
+const float kInjectEnergy = 25.0f;
+const float kTumorCastRange = 10.0f;                  // How far a tumor can place its child
+const float kQueenCreepRange = 12.0f;                 // How far a queen walks to plant a tumor
+const int kCreepSpreadSteps = 16;                     // Steps between creep spreading passes
+const uint32_t kTumorConfirmLoops = 112;              // A tumor spread that shows no order or child after 5 seconds is cast again
+const float kTumorChildDistance = 1.0f;               // A tumor this close to a spread spot is the child of that spread
+const uint32_t kBuilderTimeoutLoops = 448;            // A builder that has not started after 20 seconds is free again
+const uint32_t kGasTravelLoops = 224;                 // Drones sent to gas this recently may not count as assigned yet
+const int kRegistrySweepSteps = 224;                  // Steps between removals of units that left without a death event
+const size_t kMainSquadAttackSize = 10;               // Main squad attacks at this size, the defense squad stays home
+const size_t kHarassSquadSize = 5;                    // Mutalisks raid once this many are together
+const float kBaseClearedDistance = 6.0f;              // Main squad this close to an empty enemy base moves on to the next one
+const float kRallyBehindChoke = 4.0f;                 // Rally this far back from the choke toward the base, out of the way
+const int kBileSteps = 4;                             // Steps between Corrosive Bile plans
+const int kScoutSteps = 8;                            // Steps between scout plans
+const size_t kOverlordScouts = 2;                     // The first overlord watches the enemy natural, the next one another expansion
+const size_t kZerglingScouts = 1;                     // Taken from the main squad while it gathers
+const float kEnemyNaturalWeight = 4.0f;               // Scout site weights, other expansions weigh 1
+const float kEnemyMainWeight = 3.0f;
+const float kMainBaseDistance = 10.0f;                // Expansions this close to a start location are that main base
+
+namespace {
+struct ScopedTimer { // Adds the lifetime of the scope to a nanosecond counter
+	explicit ScopedTimer(int64_t &nanoseconds) : nanoseconds_(nanoseconds), start_(std::chrono::steady_clock::now()) {}
+	~ScopedTimer() { nanoseconds_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count(); }
+	int64_t &nanoseconds_;
+	std::chrono::steady_clock::time_point start_;
+};
+} // namespace
+
 void BasicSc2Bot::OnGameStart() {
 	// expansions_ = search::CalculateExpansionLocations(Observation(), Query());
 	startLocation_ = Observation()->GetStartLocation();
 	enemy_base_locations_ = Observation()->GetGameInfo().enemy_start_locations; // Store possible enemy base locations
 	current_target_index_ = 0;                                                  // Initialize the target index
+
+	if (LoadBuildOrder(kBuildOrderFile, build_order_)) { // Optional opener, the default macro logic runs without it
+		std::cout << "Loaded " << build_order_.size() << " step build order from " << kBuildOrderFile << std::endl;
+	}
+	build_order_index_ = 0;
+	build_order_stall_steps_ = 0;
+	creep_.Reset(Observation()->GetGameInfo());
+	spent_tumors_.clear();
+	tumor_casts_.clear();
+	visibility_.Reset(Observation()->GetGameInfo());
+	scouts_.Reset(); // Sites are added once the expansions are known
+
+	step_units_.Invalidate(); // A new game can start on the loop the last one was left at
+	units_.Clear();
+	squads_.Reset(); // Combat units join squads as they show up in the snapshot
+	bile_.Reset();
+	queen_manager_.Reset(); // Later units are registered from the unit events
+	for (const auto &base : GetActiveBases()) {
+		if (base->build_progress >= 1.0f) {
+			queen_manager_.AddHatchery(base);
+		}
+	}
+	for (const auto &queen : GetUnitsOfType(UNIT_TYPEID::ZERG_QUEEN)) {
+		queen_manager_.AddQueen(queen);
+	}
+
+	unsigned int workers = ThreadPool::DefaultWorkers();
+	if (pipelined_) { // Background analysis needs a thread of its own to overlap with the game
+		workers = std::max(workers, 1u);
+	}
+	analysis_pool_.reset(new ThreadPool(workers));
+
+	regions_.Build(Observation()->GetGameInfo(), *analysis_pool_);
+	std::cout << "Map analysis: " << regions_.Regions().size() << " regions, " << regions_.Chokes().size() << " chokes in " << regions_.BuildMilliseconds() << " ms"
+	          << std::endl;
+}
+
+void BasicSc2Bot::OnGameEnd() {
+	if (analysis_pool_) {
+		analysis_pool_->Wait();
+	}
+	if (trace_.IsOpen()) {
+		trace_.Close();
+		std::cout << "Decision trace closed, " << trace_.Dropped() << " records dropped" << std::endl;
+	}
+	if (timed_steps_ == 0) {
+		return;
+	}
+	std::cout << "Inject uptime: " << queen_manager_.InjectUptime() * 100.0f << "%" << std::endl;
+
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - first_step_time_).count();
+	double steps_per_second = timed_steps_ / elapsed;
+	std::cout << "Steps: " << timed_steps_ << " in " << elapsed << "s (" << steps_per_second << " steps/s " << (pipelined_ ? "pipelined" : "serial") << "), OnStep "
+	          << step_nanoseconds_ / 1e6 / timed_steps_ << " ms/step, analysis " << analysis_nanoseconds_ / 1e6 / timed_steps_ << " ms/step" << std::endl;
+	if (trace_nanoseconds_ > 0) { // Tracing is meant to stay under 1% of the step
+		std::cout << "Decision trace: " << trace_nanoseconds_ / 1e3 / timed_steps_ << " us/step, " << trace_nanoseconds_ * 100.0 / step_nanoseconds_ << "% of OnStep" << std::endl;
+	}
+	if (pipelined_) { // Measured only, compare with a serial run of the same game for the gain
+		std::cout << "Pipelined: OnStep waited " << wait_nanoseconds_ / 1e6 / timed_steps_ << " ms/step for the background analysis" << std::endl;
+	}
+#if defined(BASICSC2BOT_OBSERVATION_STATS)
+	observation_stats_.Print(std::cout);
+#endif
 }
 
 void BasicSc2Bot::OnStep() {
+#if defined(BASICSC2BOT_OBSERVATION_STATS) // Before the step timer, the stats decode is not part of the bot's step
+	const SC2APIProtocol::Observation *raw_observation = Observation()->GetRawObservation();
+	if (raw_observation) {
+		const StepUnits &units = CurrentUnits();
+		observation_stats_.Record(*raw_observation, units.All().size(), units.CopiedBytes());
+	}
+#endif
+	step_start_ = std::chrono::steady_clock::now();
+	if (timed_steps_++ == 0) {
+		first_step_time_ = step_start_;
+	}
+
+	StepBot();
+
+	int64_t step_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - step_start_).count();
+	step_nanoseconds_ += step_nanoseconds;
+	if (metrics_.IsRunning()) {
+		PublishMetrics(step_nanoseconds);
+	}
+	if (trace_.IsOpen()) { // One record per step carries its total time
+		auto trace_start = std::chrono::steady_clock::now();
+		TraceRecord record = {};
+		record.game_loop = Observation()->GetGameLoop();
+		record.step_micros = static_cast<uint32_t>(step_nanoseconds / 1000);
+		record.minerals = Observation()->GetMinerals();
+		record.vespene = Observation()->GetVespene();
+		record.supply_used = static_cast<uint16_t>(Observation()->GetFoodUsed());
+		record.supply_cap = static_cast<uint16_t>(Observation()->GetFoodCap());
+		record.source = static_cast<uint8_t>(TraceSource::Step);
+		record.reason = static_cast<uint8_t>(TraceReason::StepEnd);
+		trace_.Record(record);
+		trace_nanoseconds_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_start).count();
+	}
+}
+
+void BasicSc2Bot::StepBot() {
 	++step_counter;
 	// Wait for 10 frames
 	if (step_counter < 10) {
@@ -26,11 +163,46 @@ void BasicSc2Bot::OnStep() {
 	if (expansion_once) {
 		expansions_ = search::CalculateExpansionLocations(Observation(), Query());
 		expansion_once = false;
+		regions_.LinkExpansions(expansions_);
+		int start_region = regions_.RegionAt(startLocation_);
+		expansion_distances_.clear();
+		for (size_t i = 0; i < expansions_.size(); ++i) { // Ground distance, so an expansion across a cliff does not look close
+			expansion_distances_.push_back(regions_.PathDistance(startLocation_, start_region, expansions_[i], regions_.ExpansionRegion(i)));
+		}
+		AddScoutSites();
+	}
+	forecaster_.Update(Observation());
+	if (step_counter % kRegistrySweepSteps == 0) { // Drones that became buildings leave without a death event
+		const ObservationInterface *observation = Observation();
+		units_.EraseIf([observation](const UnitRecord &record) { return observation->GetUnit(record.tag) == nullptr; });
+	}
+	const SC2APIProtocol::Observation *raw_observation = Observation()->GetRawObservation();
+	if (raw_observation && raw_observation->has_raw_data() && raw_observation->raw_data().has_map_state()) {
+		const auto &creep = raw_observation->raw_data().map_state().creep();
+		creep_.Update(creep.data(), creep.bits_per_pixel());
+		const auto &visibility = raw_observation->raw_data().map_state().visibility();
+		visibility_.Update(visibility.data(), visibility.bits_per_pixel(), Observation()->GetGameLoop());
+	}
+
+	// Analysis phase: independent read-only tasks over a snapshot, run on the pool. Everything
+	// below is the commit phase and issues actions on the game thread.
+	RunAnalysisPhase();
+	QueenInjectLarvae(); // Every step, so injects go out on the step the energy is there
+	ManageArmy();        // Every step, squads only order members that are idle or need a new target
+	if (step_counter % kBileSteps == 0) {
+		CastCorrosiveBile();
+	}
+	if (step_counter % kScoutSteps == 0) {
+		Scout();
+	}
+
+	if (ExecuteBuildOrder()) { // Follow the loaded opener before the default macro logic
+		return;
 	}
 	const ObservationInterface *observation = Observation();
 
 	if (observation->GetFoodWorkers() < (10 * GetActiveBases().size())) {
-		if (TrainUnitFromLarvae(ABILITY_ID::TRAIN_DRONE, 50)) {
+		if (TrainUnitFromLarvae(ABILITY_ID::TRAIN_DRONE)) {
 			return;
 		}
 	}
@@ -38,21 +210,23 @@ void BasicSc2Bot::OnStep() {
 	Units spawning_pools = GetUnitsOfType(UNIT_TYPEID::ZERG_SPAWNINGPOOL);
 	if (spawning_pools.empty()) {
 		if (once && observation->GetMinerals() > 200) {
-			TryBuildStructure(ABILITY_ID::BUILD_SPAWNINGPOOL, UNIT_TYPEID::ZERG_SPAWNINGPOOL, 200, 0);
+			TryBuildStructure(UNIT_TYPEID::ZERG_SPAWNINGPOOL);
 			once = false;
 		} else if (!once && observation->GetMinerals() > 600) {
-			TryBuildStructure(ABILITY_ID::BUILD_SPAWNINGPOOL, UNIT_TYPEID::ZERG_SPAWNINGPOOL, 200, 0);
+			TryBuildStructure(UNIT_TYPEID::ZERG_SPAWNINGPOOL);
 		}
 	} else if (spawning_pools.front()->build_progress < 1.0f) { // Wait for spawnning pool to complete
 		return;
 	}
+	if (step_counter % kCreepSpreadSteps == 0) { // Costs energy only, so it runs ahead of the spending below
+		SpreadCreep();
+	}
 	if (TryTrainOverlord()) // If overlord trained then return
 		return;
-	if (TrainArmyUnits()) { // If army units trained then return
+	if (!ShouldSaveForTech() && TrainArmyUnits()) { // If army units trained then return
 		return;
 	}
 
-	QueenInjectLarvae();
 	TryBuildTechStructuresAndUpgrades();
 	AssignWorkersToExtractors();
 	BalanceWorkers();
@@ -60,7 +234,7 @@ void BasicSc2Bot::OnStep() {
 	if (observation->GetMinerals() > 100 && observation->GetFoodWorkers() < 70) { // If enough minerals and worker units not enough
 		for (const auto &base : GetActiveBases()) {
 			if (base->ideal_harvesters > base->assigned_harvesters) {
-				if (TrainUnitFromLarvae(ABILITY_ID::TRAIN_DRONE, 50)) // Train one drone at a time to prevent overproduction
+				if (TrainUnitFromLarvae(ABILITY_ID::TRAIN_DRONE)) // Train one drone at a time to prevent overproduction
 					break;
 			}
 		}
@@ -69,75 +243,127 @@ void BasicSc2Bot::OnStep() {
 	// Try to expand if we have less than max_bases and sufficient army units
 	const int max_bases = 4;
 	Units bases = GetActiveBases();
-	if (bases.size() < max_bases && observation->GetMinerals() >= 300) {
-		Units combat_units = observation->GetUnits(Unit::Alliance::Self, [](const Unit &unit) { // Check if we have some combat units before expanding
-			return unit.unit_type == UNIT_TYPEID::ZERG_ZERGLING || unit.unit_type == UNIT_TYPEID::ZERG_ROACH || unit.unit_type == UNIT_TYPEID::ZERG_HYDRALISK ||
-			       unit.unit_type == UNIT_TYPEID::ZERG_MUTALISK;
-		});
+	if (bases.size() < max_bases && observation->GetMinerals() < 300) {
+		PrepareExpansion();
+	} else if (bases.size() < max_bases) {
+		Units combat_units = observation->GetUnits(Unit::Alliance::Self, [](const Unit &unit) { return IsCombatUnitType(unit.unit_type); }); // Check if we have some combat units before expanding
 		if (combat_units.size() >= 0) { // Ensure we have a certain amount of combat units before expanding
 			if (TryExpand(ABILITY_ID::BUILD_HATCHERY, UNIT_TYPEID::ZERG_DRONE)) {
 				return;
 			}
 		}
 	}
-	ManageArmy();
 	TryUpgradeBase(); // Try to upgrade base
 	MorphRoachesToRavagers();
 }
 
+void BasicSc2Bot::OnUnitCreated(const Unit *unit) {
+	if (unit->alliance == Unit::Alliance::Self && unit->unit_type == UNIT_TYPEID::ZERG_QUEEN) {
+		queen_manager_.AddQueen(unit);
+	}
+}
+
+void BasicSc2Bot::OnBuildingConstructionComplete(const Unit *unit) {
+	if (unit->unit_type == UNIT_TYPEID::ZERG_HATCHERY) {
+		queen_manager_.AddHatchery(unit);
+	}
+}
+
+void BasicSc2Bot::OnUnitDestroyed(const Unit *unit) {
+	if (unit->alliance != Unit::Alliance::Self) {
+		return;
+	}
+	queen_manager_.Remove(unit->tag);
+	const UnitRecord *record = units_.Find(unit->tag);
+	if (record && record->role == UnitRole::Army) {
+		squads_.Remove(unit->tag, static_cast<SquadRole>(record->group));
+	} else if (record && record->role == UnitRole::Scout) {
+		scouts_.Remove(unit, Observation()->GetGameLoop());
+	}
+	units_.Erase(unit->tag);
+	spent_tumors_.erase(unit->tag);
+	tumor_casts_.erase(unit->tag);
+}
+
 void BasicSc2Bot::OnUnitIdle(const Unit *unit) {
 	switch (unit->unit_type.ToType()) {
 	case UNIT_TYPEID::ZERG_DRONE: {
+		if (unit->tag == expansion_drone_) { // Arrived ahead of the money, PrepareExpansion decides when it goes back
+			break;
+		}
 		const Unit *mineral_target = FindNearestMineralPatch(unit->pos);
 		if (mineral_target) {
-			Actions()->UnitCommand(unit, ABILITY_ID::SMART, mineral_target);
+			Command(TraceSource::OnUnitIdle, TraceReason::Idle, unit, ABILITY_ID::SMART, mineral_target);
+			units_.Assign(unit->tag, UnitRole::Minerals, mineral_target->tag, Observation()->GetGameLoop());
 		}
 		break;
 	}
-	case UNIT_TYPEID::ZERG_QUEEN: { // Queens should inject larvae
-		QueenInjectLarvae();
-		break;
-	}
-	case UNIT_TYPEID::ZERG_ZERGLING: // Move combat units to a rally point instead of attacking immediately
-	case UNIT_TYPEID::ZERG_ROACH:
-	case UNIT_TYPEID::ZERG_HYDRALISK:
-	case UNIT_TYPEID::ZERG_MUTALISK:
-	case UNIT_TYPEID::ZERG_RAVAGER: {
-		Point2D rally_point = GetArmyRallyPoint();
-		Actions()->UnitCommand(unit, ABILITY_ID::ATTACK, rally_point);
-		ManageArmy();
-		break;
-	}
 	case UNIT_TYPEID::ZERG_SPIRE: { // Research upgrades if not already researching
 		if (unit->orders.empty()) {
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_ZERGFLYERARMORLEVEL1);
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_ZERGFLYERATTACKLEVEL1);
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_ZERGFLYERARMORLEVEL2);
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_ZERGFLYERATTACKLEVEL2);
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_ZERGFLYERARMORLEVEL3);
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_ZERGFLYERATTACKLEVEL3);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_ZERGFLYERARMORLEVEL1);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_ZERGFLYERATTACKLEVEL1);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_ZERGFLYERARMORLEVEL2);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_ZERGFLYERATTACKLEVEL2);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_ZERGFLYERARMORLEVEL3);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_ZERGFLYERATTACKLEVEL3);
 		}
 		break;
 	}
 	case UNIT_TYPEID::ZERG_HYDRALISKDEN: { // Research upgrades if not already researching
 		if (unit->orders.empty()) {
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_GROOVEDSPINES);
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_MUSCULARAUGMENTS);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_GROOVEDSPINES);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_MUSCULARAUGMENTS);
 		}
 		break;
 	}
 	case UNIT_TYPEID::ZERG_SPAWNINGPOOL: { // Research upgrades if not already researching
 		if (unit->orders.empty()) {
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_ZERGLINGMETABOLICBOOST);
-			Actions()->UnitCommand(unit, ABILITY_ID::RESEARCH_ZERGLINGADRENALGLANDS);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_ZERGLINGMETABOLICBOOST);
+			Command(TraceSource::OnUnitIdle, TraceReason::Upgrade, unit, ABILITY_ID::RESEARCH_ZERGLINGADRENALGLANDS);
 		}
 		break;
 	}
-	default:
+	default: // Idle combat units get their squad's order in ManageArmy
 		break;
 	}
 }
 
+bool BasicSc2Bot::NextTechCost(int &mineral_cost, int &vespene_cost) { // Mirrors the order of TryBuildTechStructuresAndUpgrades
+	if (!HasCompletedStructure(UNIT_TYPEID::ZERG_SPAWNINGPOOL)) {
+		return false;
+	}
+	UNIT_TYPEID next = UNIT_TYPEID::INVALID;
+	Units lairs = GetUnitsOfType(UNIT_TYPEID::ZERG_LAIR);
+	if (GetUnitsOfType(UNIT_TYPEID::ZERG_ROACHWARREN).empty()) {
+		next = UNIT_TYPEID::ZERG_ROACHWARREN;
+	} else if (lairs.empty()) {
+		next = UNIT_TYPEID::ZERG_LAIR;
+	} else if (lairs.front()->build_progress < 1.0f) {
+		return false;
+	} else {
+		Units hydralisk_dens = GetUnitsOfType(UNIT_TYPEID::ZERG_HYDRALISKDEN);
+		if (hydralisk_dens.empty()) {
+			next = UNIT_TYPEID::ZERG_HYDRALISKDEN;
+		} else if (hydralisk_dens.front()->build_progress == 1.0f && GetUnitsOfType(UNIT_TYPEID::ZERG_SPIRE).empty()) {
+			next = UNIT_TYPEID::ZERG_SPIRE;
+		} else {
+			return false;
+		}
+	}
+	mineral_cost = UnitData(next).minerals;
+	vespene_cost = UnitData(next).vespene;
+	return true;
+}
+
+bool BasicSc2Bot::ShouldSaveForTech() {
+	int mineral_cost = 0;
+	int vespene_cost = 0;
+	if (!NextTechCost(mineral_cost, vespene_cost)) {
+		return false;
+	}
+	return forecaster_.CanAffordWithin(mineral_cost, vespene_cost, kTechSaveSeconds); // Includes affordable now, so tech is built this step
+}
+
 bool BasicSc2Bot::TrainArmyUnits() {
 	bool trained_unit = false;
 
@@ -158,42 +384,39 @@ bool BasicSc2Bot::TrainArmyUnits() {
 
 	// Train combat units based on available tech structures and unit counts
 	if (!spawning_pools.empty() && spawning_pools.front()->build_progress == 1.0f && zergling_count < max_zerglings) {
-		trained_unit |= TrainUnitFromLarvae(ABILITY_ID::TRAIN_ZERGLING, 50);
+		trained_unit |= TrainUnitFromLarvae(ABILITY_ID::TRAIN_ZERGLING);
 	}
 	if (!roach_warrens.empty() && roach_warrens.front()->build_progress == 1.0f && roach_count < max_roaches) {
-		trained_unit |= TrainUnitFromLarvae(ABILITY_ID::TRAIN_ROACH, 75, 25);
+		trained_unit |= TrainUnitFromLarvae(ABILITY_ID::TRAIN_ROACH);
 	}
 	if (!hydralisk_dens.empty() && hydralisk_dens.front()->build_progress == 1.0f && hydralisk_count < max_hydralisks) {
-		trained_unit |= TrainUnitFromLarvae(ABILITY_ID::TRAIN_HYDRALISK, 100, 50);
+		trained_unit |= TrainUnitFromLarvae(ABILITY_ID::TRAIN_HYDRALISK);
 	}
 	if (!spires.empty() && spires.front()->build_progress == 1.0f && mutalisk_count < max_mutalisks) {
-		trained_unit |= TrainUnitFromLarvae(ABILITY_ID::TRAIN_MUTALISK, 100, 100);
+		trained_unit |= TrainUnitFromLarvae(ABILITY_ID::TRAIN_MUTALISK);
 	}
 
 	return trained_unit;
 }
 
-int BasicSc2Bot::CountUnitType(UNIT_TYPEID unit_type) {
-	Units units = Observation()->GetUnits(Unit::Alliance::Self, [unit_type](const Unit &unit) { return unit.unit_type == unit_type; });
-	return static_cast<int>(units.size());
-}
+int BasicSc2Bot::CountUnitType(UNIT_TYPEID unit_type) { return CurrentUnits().Count(unit_type); }
+
+bool BasicSc2Bot::CanAfford(const ZergUnitData &data) { return Observation()->GetMinerals() >= data.minerals && Observation()->GetVespene() >= data.vespene; }
 
-bool BasicSc2Bot::TrainUnitFromLarvae(ABILITY_ID unit_ability, int mineral_cost, int vespene_cost) {
+bool BasicSc2Bot::TrainUnitFromLarvae(ABILITY_ID unit_ability) {
 	Units larvae = GetUnitsOfType(UNIT_TYPEID::ZERG_LARVA);
 	if (larvae.empty()) { // Ensure larvae is not empty
 		return false;
 	}
 
-	for (const auto &larva : larvae) {
-		if (Observation()->GetMinerals() >= mineral_cost && Observation()->GetVespene() >= vespene_cost) {
-			Actions()->UnitCommand(larva, unit_ability);
-			return true;
-		}
+	if (!CanAfford(AbilityData(unit_ability))) {
+		return false;
 	}
-	return false;
+	Command(TraceSource::TrainUnitFromLarvae, LarvaTraceReason(unit_ability), larvae.front(), unit_ability);
+	return true;
 }
 
-bool BasicSc2Bot::TryBuildStructure(ABILITY_ID build_structure, UNIT_TYPEID structure_id, int mineral_cost, int vespene_cost) {
+bool BasicSc2Bot::TryBuildStructure(UNIT_TYPEID structure_id) {
 	Units existing_structures = GetUnitsOfType(structure_id); // Check if the structure already exists or is under construction
 	for (const auto &structure : existing_structures) {
 		if (structure->build_progress < 1.0f) { // Already building this structure
@@ -201,7 +424,8 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID build_structure, UNIT_TYPEID stru
 		}
 	}
 
-	if (Observation()->GetMinerals() < mineral_cost || Observation()->GetVespene() < vespene_cost) {
+	const ZergUnitData &structure = UnitData(structure_id);
+	if (!CanAfford(structure)) {
 		return false;
 	}
 	Units drones = GetUnitsOfType(UNIT_TYPEID::ZERG_DRONE);
@@ -211,7 +435,7 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID build_structure, UNIT_TYPEID stru
 
 	const Unit *drone = nullptr;
 	for (const auto &d : drones) { // Find idle drone or drone gathering minerals
-		if (d->orders.empty() || d->orders[0].ability_id == ABILITY_ID::HARVEST_GATHER) {
+		if (IsAvailableWorker(d)) {
 			drone = d;
 			break;
 		}
@@ -220,44 +444,15 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID build_structure, UNIT_TYPEID stru
 		return false;
 	}
 
-	Units bases = GetActiveBases();
-	const Unit *base = nullptr;
-	for (const auto &b : bases) { // Find complete base
-		if (b->build_progress == 1.0f) {
-			base = b;
-			break;
+	for (const auto &test_position : analysis_.placement.candidates) { // Spaced candidates around our first finished base
+		if (!creep_.HasCreepFootprint(test_position, 3)) { // Creep comes from the grid, only spots with creep are queried for blockers
+			continue;
 		}
-	}
-	if (!base) {
-		return false;
-	}
-
-	Point2D base_position = base->pos;
-	const float max_search_radius = 10.0f;    // Maximum radius to search for placement
-	const float step_size = 1.0f;             // Step size for expanding the search
-	const float min_structure_spacing = 3.0f; // Minimum spacing between structures
-
-	for (float radius = 2.0f; radius <= max_search_radius; radius += step_size) {
-		for (float x_offset = -radius; x_offset <= radius; x_offset += step_size) {
-			for (float y_offset = -radius; y_offset <= radius; y_offset += step_size) {
-				if (sqrt(x_offset * x_offset + y_offset * y_offset) > radius) { // Skip positions outside circular search radius
-					continue;
-				}
-				Point2D test_position = Point2D(base_position.x + x_offset, base_position.y + y_offset);
-				bool is_too_close = false;
-				for (const Unit *existing_structure : Observation()->GetUnits(Unit::Alliance::Self)) {
-					if (DistanceSquared2D(test_position, existing_structure->pos) < min_structure_spacing * min_structure_spacing) {
-						is_too_close = true;
-						break;
-					}
-				}
-
-				if (!is_too_close && Query()->Placement(build_structure, test_position)) { // Validate placement
-					Actions()->UnitCommand(drone, ABILITY_ID::STOP);
-					Actions()->UnitCommand(drone, build_structure, test_position);
-					return true;
-				}
-			}
+		if (Query()->Placement(structure.ability, test_position)) { // Validate placement
+			Command(TraceSource::TryBuildStructure, TraceReason::Tech, drone, ABILITY_ID::STOP);
+			Command(TraceSource::TryBuildStructure, TraceReason::Tech, drone, structure.ability, test_position);
+			units_.Assign(drone->tag, UnitRole::Builder, NullTag, Observation()->GetGameLoop());
+			return true;
 		}
 	}
 	return false;
@@ -288,7 +483,7 @@ void BasicSc2Bot::TryBuildTechStructuresAndUpgrades() {
 	Units roach_warrens = GetUnitsOfType(UNIT_TYPEID::ZERG_ROACHWARREN);
 	if (!spawning_pools.empty() && spawning_pools.front()->build_progress == 1.0f &&
 	    roach_warrens.empty()) { // Build roach warren if we have built spawnning pool and no roach warren
-		TryBuildStructure(ABILITY_ID::BUILD_ROACHWARREN, UNIT_TYPEID::ZERG_ROACHWARREN, 150);
+		TryBuildStructure(UNIT_TYPEID::ZERG_ROACHWARREN);
 	}
 
 	Units lairs = GetUnitsOfType(UNIT_TYPEID::ZERG_LAIR);
@@ -297,11 +492,11 @@ void BasicSc2Bot::TryBuildTechStructuresAndUpgrades() {
 	} else if (!lairs.empty() && lairs.front()->build_progress == 1.0f) { // If lair is built, check and make hydralisk den and spire
 		Units hydralisk_dens = GetUnitsOfType(UNIT_TYPEID::ZERG_HYDRALISKDEN);
 		if (hydralisk_dens.empty()) {
-			TryBuildStructure(ABILITY_ID::BUILD_HYDRALISKDEN, UNIT_TYPEID::ZERG_HYDRALISKDEN, 100, 50);
+			TryBuildStructure(UNIT_TYPEID::ZERG_HYDRALISKDEN);
 		} else if (hydralisk_dens.front()->build_progress == 1.0f) {
 			Units spires = GetUnitsOfType(UNIT_TYPEID::ZERG_SPIRE);
 			if (spires.empty()) {
-				TryBuildStructure(ABILITY_ID::BUILD_SPIRE, UNIT_TYPEID::ZERG_SPIRE, 200, 150);
+				TryBuildStructure(UNIT_TYPEID::ZERG_SPIRE);
 			}
 		}
 	}
@@ -314,6 +509,24 @@ Point2D BasicSc2Bot::GetArmyRallyPoint() { // Set the rally point of combat unit
 		return startLocation_;
 	}
 
+	if (regions_.Built() && !enemy_base_locations_.empty()) { // Hold the choke in front of the base closest to the enemy by ground
+		const Unit *front_base = nullptr;
+		float closest_distance = std::numeric_limits<float>::max();
+		for (const auto &base : bases) {
+			float distance = regions_.PathDistance(base->pos, enemy_base_locations_.front());
+			if (distance < closest_distance) {
+				closest_distance = distance;
+				front_base = base;
+			}
+		}
+		const Chokepoint *choke = front_base ? regions_.GuardingChoke(front_base->pos) : nullptr;
+		if (choke) {
+			Point2D back = front_base->pos - choke->pos;
+			float length = std::sqrt(back.x * back.x + back.y * back.y);
+			return length > kRallyBehindChoke ? choke->pos + back * (kRallyBehindChoke / length) : choke->pos;
+		}
+	}
+
 	float avg_x = 0.0f; // Calculate the average position (center) of all bases
 	float avg_y = 0.0f;
 	for (const auto &base : bases) {
@@ -328,94 +541,106 @@ Point2D BasicSc2Bot::GetArmyRallyPoint() { // Set the rally point of combat unit
 }
 
 void BasicSc2Bot::BalanceWorkers() { // Balance workers assigned to base
+	const SaturationAnalysis &saturation = analysis_.saturation;
+	if (saturation.undersaturated_bases.empty()) {
+		return;
+	}
 	const ObservationInterface *observation = Observation();
-	Units all_bases = GetUnitsOfType(UNIT_TYPEID::ZERG_HATCHERY);
-	Units lairs = GetUnitsOfType(UNIT_TYPEID::ZERG_LAIR);
-	Units hives = GetUnitsOfType(UNIT_TYPEID::ZERG_HIVE);
-	all_bases.insert(all_bases.end(), lairs.begin(), lairs.end());
-	all_bases.insert(all_bases.end(), hives.begin(), hives.end());
-
-	std::vector<const Unit *> undersaturated_bases;
-	std::vector<const Unit *> oversaturated_bases;
 
-	for (const auto &base : all_bases) { // Skip incomplete or mined-out bases
-		if (base->build_progress < 1.0f || base->ideal_harvesters == 0) {
-			continue;
+	oversaturated_bases_.clear(); // Surplus from the live bases, the analysis may be a step old
+	for (auto oversaturated : saturation.oversaturated_bases) {
+		const Unit *base = observation->GetUnit(oversaturated.base);
+		if (base) { // Not destroyed since the analysis ran
+			oversaturated.surplus = base->assigned_harvesters - base->ideal_harvesters;
+			oversaturated_bases_.push_back(oversaturated);
 		}
+	}
 
-		int workers_needed = base->ideal_harvesters - base->assigned_harvesters;
-		if (workers_needed > 0) {
-			undersaturated_bases.push_back(base);
-		} else if (workers_needed < 0) {
-			oversaturated_bases.push_back(base);
+	worker_transfers_.clear();
+	PlanWorkerBalance(snapshot_, oversaturated_bases_, saturation.undersaturated_bases, units_, worker_transfers_);
+	for (const auto &transfer : worker_transfers_) { // Assign workers to undersaturated base
+		const Unit *mineral_patch = observation->GetUnit(transfer.mineral);
+		const Unit *drone = observation->GetUnit(transfer.drone);
+		if (mineral_patch && drone) {
+			Command(TraceSource::BalanceWorkers, TraceReason::Saturation, drone, ABILITY_ID::SMART, mineral_patch);
+			units_.Assign(drone->tag, UnitRole::Minerals, mineral_patch->tag, observation->GetGameLoop());
 		}
 	}
+}
 
-	if (undersaturated_bases.empty()) {
-		return;
+void BasicSc2Bot::Scout() {
+	const ObservationInterface *observation = Observation();
+	uint32_t game_loop = observation->GetGameLoop();
+	if (scouts_.Count(UNIT_TYPEID::ZERG_OVERLORD) < kOverlordScouts) { // One recruit per plan, the others keep giving supply at home
+		for (const auto &overlord : GetUnitsOfType(UNIT_TYPEID::ZERG_OVERLORD)) {
+			if (overlord->orders.empty() && units_.Role(overlord->tag) == UnitRole::None) {
+				scouts_.Add(overlord);
+				units_.Assign(overlord->tag, UnitRole::Scout, NullTag, game_loop);
+				break;
+			}
+		}
 	}
-
-	for (const auto &oversaturated_base : oversaturated_bases) { // Go through all bases and redistribute
-		int extra_workers = oversaturated_base->assigned_harvesters - oversaturated_base->ideal_harvesters;
-		if (extra_workers <= 0) {
-			continue;
+	const Squad &main_squad = squads_.Get(SquadRole::Main);
+	if (scouts_.Count(UNIT_TYPEID::ZERG_ZERGLING) < kZerglingScouts && main_squad.members.size() < kMainSquadAttackSize) { // Not while it attacks
+		for (const auto &member : main_squad.members) {
+			const Unit *unit = observation->GetUnit(member.tag);
+			if (unit && unit->unit_type == UNIT_TYPEID::ZERG_ZERGLING) {
+				squads_.Remove(unit->tag, SquadRole::Main); // Invalidates member, so leave the loop right after
+				scouts_.Add(unit);
+				units_.Assign(unit->tag, UnitRole::Scout, NullTag, game_loop);
+				break;
+			}
 		}
+	}
 
-		Units workers = observation->GetUnits(Unit::Alliance::Self, [oversaturated_base](const Unit &unit) {
-			if (unit.unit_type != UNIT_TYPEID::ZERG_DRONE) {
-				return false;
-			}
-			if (unit.orders.empty()) {
-				return false;
-			}
-			if (DistanceSquared2D(unit.pos, oversaturated_base->pos) < 100.0f) {
-				return true;
-			}
-			return false;
-		});
+	scouts_.Plan(observation, visibility_, game_loop, startLocation_, scout_orders_);
+	for (const auto &order : scout_orders_) {
+		Command(TraceSource::Scout, order.retreat ? TraceReason::Retreat : TraceReason::Scout, order.unit, ABILITY_ID::MOVE, order.target);
+	}
+}
 
-		for (auto &worker : workers) {
-			if (extra_workers <= 0) {
-				break;
-			}
-			const Unit *target_base = nullptr;
-			float min_distance = std::numeric_limits<float>::max();
-			for (const auto &undersaturated_base : undersaturated_bases) {
-				float distance = DistanceSquared2D(worker->pos, undersaturated_base->pos);
-				if (distance < min_distance) {
-					min_distance = distance;
-					target_base = undersaturated_base;
-				}
+void BasicSc2Bot::AddScoutSites() {
+	for (const auto &enemy_start : enemy_base_locations_) { // Every possible enemy start, the enemy natural of each one
+		scouts_.AddSite(enemy_start, kEnemyMainWeight, true);
+	}
+	std::vector<float> weights(expansions_.size(), 1.0f);
+	for (const auto &enemy_start : enemy_base_locations_) {
+		int enemy_region = regions_.RegionAt(enemy_start);
+		size_t natural = expansions_.size();
+		float natural_distance = std::numeric_limits<float>::max();
+		for (size_t i = 0; i < expansions_.size(); ++i) {
+			if (Distance2D(expansions_[i], enemy_start) < kMainBaseDistance) {
+				continue;
 			}
-
-			if (target_base) { // Assign workers to undersaturated base
-				const Unit *mineral_patch = FindNearestMineralPatch(target_base->pos);
-				if (mineral_patch) {
-					Actions()->UnitCommand(worker, ABILITY_ID::SMART, mineral_patch);
-					extra_workers--;
-				}
+			float distance = regions_.PathDistance(enemy_start, enemy_region, expansions_[i], regions_.ExpansionRegion(i)); // By ground, a base across a cliff is not the natural
+			if (distance < natural_distance) {
+				natural_distance = distance;
+				natural = i;
 			}
 		}
+		if (natural < expansions_.size()) {
+			weights[natural] = kEnemyNaturalWeight;
+		}
+	}
+	for (size_t i = 0; i < expansions_.size(); ++i) {
+		bool main_base = Distance2D(expansions_[i], startLocation_) < kMainBaseDistance;
+		for (const auto &enemy_start : enemy_base_locations_) {
+			main_base |= Distance2D(expansions_[i], enemy_start) < kMainBaseDistance;
+		}
+		if (!main_base) { // Our main is always in sight, enemy mains are sites of their own
+			scouts_.AddSite(expansions_[i], weights[i], false);
+		}
 	}
-}
-
-bool BasicSc2Bot::IsCombatUnit(const Unit &unit) {
-	return unit.unit_type == UNIT_TYPEID::ZERG_ZERGLING || unit.unit_type == UNIT_TYPEID::ZERG_ROACH || unit.unit_type == UNIT_TYPEID::ZERG_HYDRALISK ||
-	       unit.unit_type == UNIT_TYPEID::ZERG_MUTALISK || unit.unit_type == UNIT_TYPEID::ZERG_RAVAGER;
 }
 
 void BasicSc2Bot::MorphRoachesToRavagers() {
-	const ObservationInterface *observation = Observation();
-
 	Units lairs = GetUnitsOfType(UNIT_TYPEID::ZERG_LAIR);
 	Units hives = GetUnitsOfType(UNIT_TYPEID::ZERG_HIVE);
 	if (lairs.empty() && hives.empty()) { // If we dont have lair, return
 		return;
 	}
 
-	const int ravager_morph_mineral_cost = 25;
-	const int ravager_morph_vespene_cost = 75;
-	if (observation->GetMinerals() < ravager_morph_mineral_cost || observation->GetVespene() < ravager_morph_vespene_cost) { // If not enough resources, return
+	if (!CanAfford(UnitData(UNIT_TYPEID::ZERG_RAVAGER))) { // If not enough resources, return
 		return;
 	}
 
@@ -431,7 +656,7 @@ void BasicSc2Bot::MorphRoachesToRavagers() {
 	int morphed = 0;
 	for (const auto &roach : roaches) { // If roach is idle, morph into ravager
 		if (roach->orders.empty()) {
-			Actions()->UnitCommand(roach, ABILITY_ID::MORPH_RAVAGER);
+			Command(TraceSource::MorphRoachesToRavagers, TraceReason::Morph, roach, ABILITY_ID::MORPH_RAVAGER);
 			morphed++;
 			if (morphed >= morph_count) {
 				break;
@@ -440,68 +665,124 @@ void BasicSc2Bot::MorphRoachesToRavagers() {
 	}
 }
 
-void BasicSc2Bot::ManageArmy() { // Checkpoint to see if army should attack (if we have enough army units)
-	if (Observation()->GetArmyCount() > 14) {
-		AttackWithArmy();
+void BasicSc2Bot::CastCorrosiveBile() {
+	Units ravagers = GetUnitsOfType(UNIT_TYPEID::ZERG_RAVAGER);
+	if (ravagers.empty()) {
+		return;
+	}
+	const ObservationInterface *observation = Observation();
+	uint32_t game_loop = observation->GetGameLoop();
+	bile_.Plan(ravagers, CurrentUnits().Enemy(), game_loop, bile_casts_);
+	for (const auto &cast : bile_casts_) {
+		Command(TraceSource::CastCorrosiveBile, TraceReason::Bile, cast.ravager, ABILITY_ID::EFFECT_CORROSIVEBILE, cast.target);
+		bile_.Record(cast, game_loop);
 	}
 }
 
-void BasicSc2Bot::AttackWithArmy() {
+void BasicSc2Bot::ManageArmy() { // Gives each squad one order, defense and attack can run at the same time
 	const ObservationInterface *observation = Observation();
+	uint32_t game_loop = observation->GetGameLoop();
+	for (const auto &combat_unit : snapshot_.combat_units) { // Eggs hatch without a create event, so new members come from the snapshot
+		if (units_.Role(combat_unit.tag) != UnitRole::None) { // In a squad already, or scouting
+			continue;
+		}
+		const Unit *unit = observation->GetUnit(combat_unit.tag);
+		if (unit) {
+			SquadRole role = squads_.Add(unit);
+			units_.Assign(unit->tag, UnitRole::Army, NullTag, game_loop);
+			units_.Get(unit->tag).group = static_cast<uint8_t>(role);
+		}
+	}
+	squads_.Update(observation);
+
+	Point2D rally_point = GetArmyRallyPoint();
+	const ThreatAnalysis &threat = analysis_.threat;
+	if (threat.threatened) {
+		OrderSquad(SquadRole::Defense, threat.position, TraceSource::DefendAgainstThreat, TraceReason::Defend);
+	} else {
+		OrderSquad(SquadRole::Defense, rally_point, TraceSource::ManageArmy, TraceReason::Rally);
+	}
 
-	Units combat_units = observation->GetUnits(Unit::Alliance::Self, [](const Unit &unit) { // Get all combat units
-		return unit.unit_type == UNIT_TYPEID::ZERG_ZERGLING || unit.unit_type == UNIT_TYPEID::ZERG_ROACH || unit.unit_type == UNIT_TYPEID::ZERG_HYDRALISK ||
-		       unit.unit_type == UNIT_TYPEID::ZERG_MUTALISK || unit.unit_type == UNIT_TYPEID::ZERG_RAVAGER;
-	});
+	if (threat.threatened && threat.strength > squads_.Get(SquadRole::Defense).strength) { // Defense alone would lose, bring the main squad home
+		OrderSquad(SquadRole::Main, threat.position, TraceSource::DefendAgainstThreat, TraceReason::Defend);
+	} else if (squads_.Get(SquadRole::Main).members.size() >= kMainSquadAttackSize) {
+		AttackWithArmy();
+	} else {
+		OrderSquad(SquadRole::Main, rally_point, TraceSource::ManageArmy, TraceReason::Rally);
+	}
 
-	if (combat_units.empty()) { // Ensure we have combat units
-		return;
+	if (squads_.Get(SquadRole::Harass).members.size() >= kHarassSquadSize && !enemy_base_locations_.empty()) { // Raid the enemy main while the main squad fights elsewhere
+		OrderSquad(SquadRole::Harass, enemy_base_locations_.front(), TraceSource::ManageArmy, TraceReason::Harass);
+	} else {
+		OrderSquad(SquadRole::Harass, rally_point, TraceSource::ManageArmy, TraceReason::Rally);
 	}
+}
 
-	Units enemy_units = observation->GetUnits(Unit::Alliance::Enemy); // Get enemy units
+void BasicSc2Bot::OrderSquad(SquadRole role, const Point2D &target, TraceSource source, TraceReason reason) {
+	squads_.Order(role, target, Observation(), squad_units_);
+	if (!squad_units_.empty()) {
+		Command(source, reason, squad_units_, ABILITY_ID::ATTACK, target);
+	}
+}
 
-	if (!enemy_units.empty()) { // If enemy's found, attack closest enemy
-		const Unit *target = enemy_units.front();
-		if (target) { // Ensure target is valid
-			for (const auto &unit : combat_units) {
-				if (unit->orders.empty()) {
-					Actions()->UnitCommand(unit, ABILITY_ID::ATTACK, target->pos);
-				}
-			}
+void BasicSc2Bot::AttackWithArmy() {
+	if (analysis_.target.has_target) { // If enemy's found, attack the enemy closest to the army
+		OrderSquad(SquadRole::Main, analysis_.target.target, TraceSource::AttackWithArmy, TraceReason::Attack);
+	} else if (!enemy_base_locations_.empty()) { // If no enemy's found, attack enemy known home base locations
+		if (current_target_index_ >= enemy_base_locations_.size()) {
+			current_target_index_ = 0;
 		}
-	} else { // If no enemy's found, attack enemy known home base locations
-		if (!enemy_base_locations_.empty()) {
-			if (current_target_index_ >= enemy_base_locations_.size()) {
-				current_target_index_ = 0;
-			}
-			Point2D target_location = enemy_base_locations_[current_target_index_];
-			for (const auto &unit : combat_units) { // Command units to attack the target location
-				if (unit->orders.empty()) {
-					Actions()->UnitCommand(unit, ABILITY_ID::ATTACK, target_location);
-				}
-			}
-
-			current_target_index_++;
+		if (DistanceSquared2D(squads_.Get(SquadRole::Main).center, enemy_base_locations_[current_target_index_]) < kBaseClearedDistance * kBaseClearedDistance) {
+			current_target_index_ = (current_target_index_ + 1) % enemy_base_locations_.size(); // Nothing there, try the next one
 		}
+		OrderSquad(SquadRole::Main, enemy_base_locations_[current_target_index_], TraceSource::AttackWithArmy, TraceReason::AttackKnownBase);
 	}
 }
 
 void BasicSc2Bot::AssignWorkersToExtractors() {
 	Units extractors = GetUnitsOfType(UNIT_TYPEID::ZERG_EXTRACTOR);
 	Units drones = GetUnitsOfType(UNIT_TYPEID::ZERG_DRONE);
+	uint32_t game_loop = Observation()->GetGameLoop();
 
 	for (const Unit *extractor : extractors) {
 		int required_workers = extractor->ideal_harvesters - extractor->assigned_harvesters;
-		if (required_workers > 0) {
-			for (int i = 0; i < required_workers && !drones.empty(); ++i) {
-				const Unit *drone = drones.back();
-				Actions()->UnitCommand(drone, ABILITY_ID::SMART, extractor);
-				drones.pop_back();
+		if (required_workers > 0) { // Drones still walking there are not in assigned_harvesters yet
+			required_workers -= units_.CountRole(UnitRole::Gas, extractor->tag, game_loop > kGasTravelLoops ? game_loop - kGasTravelLoops : 0);
+		}
+		while (required_workers > 0 && !drones.empty()) {
+			const Unit *drone = drones.back();
+			drones.pop_back();
+			if (!IsAvailableWorker(drone)) { // Claimed by a builder this step, or already on gas
+				continue;
 			}
+			Command(TraceSource::AssignWorkersToExtractors, TraceReason::Saturation, drone, ABILITY_ID::SMART, extractor);
+			units_.Assign(drone->tag, UnitRole::Gas, extractor->tag, game_loop);
+			required_workers--;
 		}
 	}
 }
 
+bool BasicSc2Bot::IsAvailableWorker(const Unit *drone) {
+	if (!drone->orders.empty() && drone->orders[0].ability_id != ABILITY_ID::HARVEST_GATHER) {
+		return false;
+	}
+	if (drone->tag == expansion_drone_) { // Held at the next expansion, its Builder role may have timed out
+		return false;
+	}
+	const UnitRecord *record = units_.Find(drone->tag);
+	if (!record) {
+		return true;
+	}
+	switch (record->role) {
+	case UnitRole::Gas:
+		return false;
+	case UnitRole::Builder:
+		return Observation()->GetGameLoop() - record->since_loop > kBuilderTimeoutLoops;
+	default:
+		return true;
+	}
+}
+
 bool BasicSc2Bot::TryBuildVespeneExtractor() {
 	const int max_extractors = GetActiveBases().size() * 2;
 	int current_extractors = GetUnitsOfType(UNIT_TYPEID::ZERG_EXTRACTOR).size();
@@ -514,8 +795,8 @@ bool BasicSc2Bot::TryBuildVespeneExtractor() {
 		return false;
 
 	const Unit *drone = nullptr;
-	for (const auto &d : drones) { // Find idle drone
-		if (d->orders.empty()) {
+	for (const auto &d : drones) { // Find idle drone or drone gathering minerals
+		if (IsAvailableWorker(d)) {
 			drone = d;
 			break;
 		}
@@ -534,175 +815,150 @@ bool BasicSc2Bot::TryBuildVespeneExtractor() {
 		}
 	}
 
-	Actions()->UnitCommand(drone, ABILITY_ID::BUILD_EXTRACTOR, vespene_geyser); // Set drone to build extractor
+	Command(TraceSource::TryBuildVespeneExtractor, TraceReason::Economy, drone, ABILITY_ID::BUILD_EXTRACTOR, vespene_geyser); // Set drone to build extractor
+	units_.Assign(drone->tag, UnitRole::Builder, vespene_geyser->tag, Observation()->GetGameLoop());
 	return true;
 }
 
 bool BasicSc2Bot::QueenInjectLarvae() {
-	Units hatcheries = GetUnitsOfType(UNIT_TYPEID::ZERG_HATCHERY);
-	Units lairs = GetUnitsOfType(UNIT_TYPEID::ZERG_LAIR);
-	Units hives = GetUnitsOfType(UNIT_TYPEID::ZERG_HIVE);
+	const ObservationInterface *observation = Observation();
+	injects_.clear();
+	queen_manager_.Update(observation, injects_); // Bound queens with inject energy whose hatchery can take one
+	for (const auto &inject : injects_) {
+		Command(TraceSource::QueenInjectLarvae, TraceReason::Inject, inject.queen, ABILITY_ID::EFFECT_INJECTLARVA, inject.hatchery);
+		queen_manager_.OnInjectIssued(inject, observation->GetGameLoop());
+	}
 
-	hatcheries.insert(hatcheries.end(), lairs.begin(), lairs.end());
-	hatcheries.insert(hatcheries.end(), hives.begin(), hives.end());
+	const Unit *base = queen_manager_.HatcheryWithoutQueen(observation);
+	if (base && base->orders.empty() && CanAfford(UnitData(UNIT_TYPEID::ZERG_QUEEN)) && HasCompletedStructure(UNIT_TYPEID::ZERG_SPAWNINGPOOL)) { // If base has no queen, make queen
+		Command(TraceSource::QueenInjectLarvae, TraceReason::QueenMissing, base, ABILITY_ID::TRAIN_QUEEN);
+		return true;
+	}
+	return !injects_.empty();
+}
 
-	for (const Unit *base : hatcheries) { // Skip incomplete bases
-		if (base->build_progress < 1.0f) {
-			continue;
-		}
-		if (!HasQueenAssigned(base)) { // If base has no queen, make queen
-			if (Observation()->GetMinerals() >= 150) {
-				Actions()->UnitCommand(base, ABILITY_ID::TRAIN_QUEEN);
-				return true;
+void BasicSc2Bot::SpreadCreep() {
+	Units tumors = Observation()->GetUnits(Unit::Alliance::Self, [](const Unit &unit) {
+		return unit.unit_type == UNIT_TYPEID::ZERG_CREEPTUMOR || unit.unit_type == UNIT_TYPEID::ZERG_CREEPTUMORBURROWED || unit.unit_type == UNIT_TYPEID::ZERG_CREEPTUMORQUEEN;
+	});
+	tumor_positions_.clear();
+	for (const auto &tumor : tumors) {
+		tumor_positions_.push_back(tumor->pos);
+	}
+	Point2D rally_point = GetArmyRallyPoint(); // Spread toward where the army gathers
+
+	// A spread command can fail without a word, so a tumor only counts as spent once it shows the
+	// order or its child appears. Until then its spot is held, after the timeout it tries again.
+	uint32_t game_loop = Observation()->GetGameLoop();
+	for (auto it = tumor_casts_.begin(); it != tumor_casts_.end();) {
+		const Unit *tumor = Observation()->GetUnit(it->first);
+		bool confirmed = false;
+		if (tumor) {
+			for (const auto &order : tumor->orders) {
+				confirmed = confirmed || order.ability_id == ABILITY_ID::BUILD_CREEPTUMOR_TUMOR;
 			}
 		}
-
-		Units queens = GetUnitsOfType(UNIT_TYPEID::ZERG_QUEEN);
-		for (const Unit *queen : queens) {
-			if (queen->energy >= 25 && DistanceSquared2D(queen->pos, base->pos) < 10 * 10) {
-				Actions()->UnitCommand(queen, ABILITY_ID::EFFECT_INJECTLARVA, base);
-				return true;
-			}
+		for (const auto &pos : tumor_positions_) {
+			confirmed = confirmed || DistanceSquared2D(pos, it->second.spot) < kTumorChildDistance * kTumorChildDistance;
+		}
+		if (confirmed) {
+			spent_tumors_.insert(it->first);
+		}
+		if (confirmed || !tumor || game_loop > it->second.game_loop + kTumorConfirmLoops) {
+			it = tumor_casts_.erase(it);
+		} else {
+			tumor_positions_.push_back(it->second.spot);
+			++it;
 		}
 	}
 
-	return false;
-}
-
-bool BasicSc2Bot::HasQueenAssigned(const Unit *base) {
-	Units queens = GetUnitsOfType(UNIT_TYPEID::ZERG_QUEEN);
-
-	for (const Unit *queen : queens) {
-		if (DistanceSquared2D(base->pos, queen->pos) < 10 * 10) {
-			return true;
+	for (const auto &tumor : tumors) { // Each burrowed tumor can place one more
+		if (tumor->unit_type != UNIT_TYPEID::ZERG_CREEPTUMORBURROWED || spent_tumors_.count(tumor->tag) || tumor_casts_.count(tumor->tag)) {
+			continue;
 		}
-	}
-	for (const auto &order : base->orders) {
-		if (order.ability_id == ABILITY_ID::TRAIN_QUEEN) { // Queen being trained at this base
-			return true;
+		tumor_spots_.clear();
+		creep_.PlanTumors(tumor->pos, kTumorCastRange, rally_point, tumor_positions_, 1, tumor_spots_);
+		if (!tumor_spots_.empty()) {
+			Command(TraceSource::SpreadCreep, TraceReason::Creep, tumor, ABILITY_ID::BUILD_CREEPTUMOR_TUMOR, tumor_spots_.front());
+			tumor_casts_[tumor->tag] = {tumor_spots_.front(), game_loop};
+			tumor_positions_.push_back(tumor_spots_.front());
 		}
 	}
 
-	return false;
+	for (const auto &queen : GetUnitsOfType(UNIT_TYPEID::ZERG_QUEEN)) { // Idle queens with energy to spare, bound queens keep enough for the next inject
+		float energy_needed = queen_manager_.IsBound(queen->tag) ? kCreepTumorEnergy + kInjectEnergy : kCreepTumorEnergy;
+		if (queen->energy < energy_needed || !queen->orders.empty()) {
+			continue;
+		}
+		tumor_spots_.clear();
+		creep_.PlanTumors(queen->pos, kQueenCreepRange, rally_point, tumor_positions_, 1, tumor_spots_);
+		if (!tumor_spots_.empty()) {
+			Command(TraceSource::SpreadCreep, TraceReason::Creep, queen, ABILITY_ID::BUILD_CREEPTUMOR_QUEEN, tumor_spots_.front());
+			tumor_positions_.push_back(tumor_spots_.front());
+		}
+	}
 }
 
 bool BasicSc2Bot::TryTrainOverlord() {
 	const ObservationInterface *observation = Observation();
 
 	if (observation->GetFoodCap() >= 200) { // Stop tarining overlords if food cap reached
-		// std::cout << "supply cap reached, stop training \n";				// For Debugging
 		return false;
 	}
 
-	if (observation->GetFoodUsed() >= observation->GetFoodCap() - 2) { // check if overlord needed
-		Units overlords = GetUnitsOfType(UNIT_TYPEID::ZERG_OVERLORD);
-		for (const auto &overlord : overlords) { // if overlord building, dont train
-			if (overlord->build_progress < 1.0f) {
-				// std::cout << "overlord already being made \n";				// For Debugging
-				return false;
-			}
-		}
-		Units larvae = GetUnitsOfType(UNIT_TYPEID::ZERG_LARVA);
-		if (!larvae.empty() && observation->GetMinerals() >= 100) {
-			Actions()->UnitCommand(larvae.front(), ABILITY_ID::TRAIN_OVERLORD);
-			// std::cout << "training new overlord \n";							// For Debugging
-			return true;
-		}
-	}
-	return false;
-}
-
-const Unit *BasicSc2Bot::FindNearestMineralPatch(const Point2D &start) {
-	Units units = Observation()->GetUnits(Unit::Alliance::Neutral);
-	if (units.empty()) { // Ensure there are units to process
-		return nullptr;
+	// Plan against the supply we will need by the time a new overlord pops, counting overlords
+	// already in eggs, so several can be made at once when larva is plentiful
+	MacroForecast forecast = forecaster_.Project(UnitData(UNIT_TYPEID::ZERG_OVERLORD).build_time);
+	if (forecast.supply_used < forecast.supply_cap - 2) {
+		return false;
 	}
 
-	float closest_distance = std::numeric_limits<float>::max();
-	const Unit *target = nullptr;
-	for (const auto &u : units) {
-		if ((u->unit_type == UNIT_TYPEID::NEUTRAL_MINERALFIELD || u->unit_type == UNIT_TYPEID::NEUTRAL_MINERALFIELD750 || u->unit_type == UNIT_TYPEID::NEUTRAL_RICHMINERALFIELD ||
-		     u->unit_type == UNIT_TYPEID::NEUTRAL_RICHMINERALFIELD750) &&
-		    u->mineral_contents > 0) {
-			float distance = DistanceSquared2D(u->pos, start);
-			if (distance < closest_distance) {
-				closest_distance = distance;
-				target = u;
-			}
-		}
+	Units larvae = GetUnitsOfType(UNIT_TYPEID::ZERG_LARVA);
+	if (!larvae.empty() && CanAfford(UnitData(UNIT_TYPEID::ZERG_OVERLORD))) {
+		Command(TraceSource::TryTrainOverlord, TraceReason::Supply, larvae.front(), ABILITY_ID::TRAIN_OVERLORD);
+		forecaster_.AddPendingSupply(UnitData(UNIT_TYPEID::ZERG_OVERLORD).build_time, 8);
+		return true;
 	}
-	return target;
+	return false;
 }
 
-const Unit *BasicSc2Bot::FindNearestVespenseGeyser(const Point2D &start) {
-	Units geysers = Observation()->GetUnits(Unit::Alliance::Neutral, [](const Unit &unit) {
-		return unit.unit_type == UNIT_TYPEID::NEUTRAL_VESPENEGEYSER || unit.unit_type == UNIT_TYPEID::NEUTRAL_PROTOSSVESPENEGEYSER ||
-		       unit.unit_type == UNIT_TYPEID::NEUTRAL_SPACEPLATFORMGEYSER;
-	});
-
-	float closest_distance = std::numeric_limits<float>::max();
-	const Unit *target = nullptr;
-
-	for (const auto &geyser : geysers) {
-		bool geyser_occupied = false; // Check for if vespene gyser is taken
-
-		Units units_on_geyser = Observation()->GetUnits(
-		    Unit::Alliance::Self, [geyser](const Unit &unit) { return unit.unit_type == UNIT_TYPEID::ZERG_EXTRACTOR && DistanceSquared2D(unit.pos, geyser->pos) < 1.0f; });
-
-		Units enemy_units_on_geyser = Observation()->GetUnits(
-		    Unit::Alliance::Enemy, [geyser](const Unit &unit) { return unit.unit_type == UNIT_TYPEID::ZERG_EXTRACTOR && DistanceSquared2D(unit.pos, geyser->pos) < 1.0f; });
+const Unit *BasicSc2Bot::FindNearestMineralPatch(const Point2D &start) { return NearestMineralPatch(CurrentUnits().Neutral(), start); }
 
-		if (!units_on_geyser.empty() || !enemy_units_on_geyser.empty()) {
-			geyser_occupied = true;
-		}
-
-		if (!geyser_occupied) {
-			float distance = DistanceSquared2D(geyser->pos, start);
-			if (distance < closest_distance) {
-				closest_distance = distance;
-				target = geyser;
-			}
-		}
-	}
-	return target;
+const Unit *BasicSc2Bot::FindNearestVespenseGeyser(const Point2D &start) { // Extractors of either side block a geyser
+	const StepUnits &units = CurrentUnits();
+	return NearestFreeGeyser(units.Neutral(), units.All(), start);
 }
 
-Units BasicSc2Bot::GetUnitsOfType(UNIT_TYPEID type) {
-	Units units = Observation()->GetUnits(Unit::Alliance::Self);
-	Units units_vector;
+Units BasicSc2Bot::GetUnitsOfType(UNIT_TYPEID type) { return CurrentUnits().OfType(type); }
 
-	for (const auto &unit : units) {
-		if (unit->unit_type == type) {    // If unit of the same type
-			units_vector.push_back(unit); // Push to the vector
-		}
+const StepUnits &BasicSc2Bot::CurrentUnits() {
+	const ObservationInterface *observation = Observation();
+	uint32_t game_loop = observation->GetGameLoop();
+	if (!step_units_.IsCurrent(game_loop)) { // Unit events run before OnStep, so the first caller of the loop refreshes
+		step_units_.Refresh(observation->GetUnits(), game_loop);
 	}
-
-	return units_vector; // Return the vector
+	return step_units_;
 }
 
 bool BasicSc2Bot::TryExpand(AbilityID build_ability, UnitTypeID worker_type) {
-	const ObservationInterface *observation = Observation();
 	std::vector<std::pair<float, Point3D>> distances;
 
 	if (expansions_.empty()) {
 		return false;
 	}
 
-	for (const auto &expansion : expansions_) { // Calculate distances for all expansions
-		float current_distance = Distance2D(startLocation_, expansion);
-		if (current_distance > 1.0f) { // Skip current base location
-			distances.push_back({current_distance, expansion});
+	for (size_t i = 0; i < expansions_.size(); ++i) { // Ground distances for all expansions
+		if (Distance2D(startLocation_, expansions_[i]) > 1.0f) { // Skip current base location
+			distances.push_back({expansion_distances_[i], expansions_[i]});
 		}
 	}
 
 	std::sort(distances.begin(), distances.end(), [](const std::pair<float, Point3D> &a, const std::pair<float, Point3D> &b) { return a.first < b.first; }); // Sort by distance
 
+	Units bases = GetActiveBases();
 	for (size_t i = 0; i < distances.size(); ++i) {
 		const Point3D &expansion = distances[i].second;
 		bool already_has_base = false;
-		Units bases = GetUnitsOfType(UNIT_TYPEID::ZERG_HATCHERY);
-		bases.insert(bases.end(), GetUnitsOfType(UNIT_TYPEID::ZERG_LAIR).begin(), GetUnitsOfType(UNIT_TYPEID::ZERG_LAIR).end());
-		bases.insert(bases.end(), GetUnitsOfType(UNIT_TYPEID::ZERG_HIVE).begin(), GetUnitsOfType(UNIT_TYPEID::ZERG_HIVE).end());
 
 		for (const auto &base : bases) { // Check if we already have a base at this location
 			if (DistanceSquared2D(base->pos, expansion) < 4.0f) {
@@ -725,6 +981,75 @@ bool BasicSc2Bot::TryExpand(AbilityID build_ability, UnitTypeID worker_type) {
 	return false;
 }
 
+bool BasicSc2Bot::FindNextExpansion(Point3D &location) {
+	Units bases = GetActiveBases();
+	float closest_distance = std::numeric_limits<float>::max();
+	bool found = false;
+
+	for (size_t i = 0; i < expansions_.size(); ++i) {
+		const Point3D &expansion = expansions_[i];
+		float distance = expansion_distances_[i];
+		if (Distance2D(startLocation_, expansion) <= 1.0f || distance >= closest_distance) { // Skip current base location and farther expansions
+			continue;
+		}
+		bool already_has_base = false;
+		for (const auto &base : bases) {
+			if (DistanceSquared2D(base->pos, expansion) < 4.0f) {
+				already_has_base = true;
+				break;
+			}
+		}
+		if (!already_has_base) {
+			closest_distance = distance;
+			location = expansion;
+			found = true;
+		}
+	}
+	return found;
+}
+
+void BasicSc2Bot::PrepareExpansion() {
+	const ZergUnitData &hatchery = UnitData(UNIT_TYPEID::ZERG_HATCHERY);
+	const Unit *sent = Observation()->GetUnit(expansion_drone_);
+	if (sent) { // On its way or waiting at the spot, unless the income dropped since it left
+		float travel_time = Distance2D(sent->pos, expansion_location_) / kDroneSpeed;
+		if (!forecaster_.CanAffordWithin(hatchery.minerals, hatchery.vespene, travel_time + kExpansionHoldSeconds)) {
+			expansion_drone_ = NullTag;
+			const Unit *mineral_target = FindNearestMineralPatch(sent->pos);
+			if (mineral_target) {
+				Command(TraceSource::PrepareExpansion, TraceReason::Economy, sent, ABILITY_ID::SMART, mineral_target);
+				units_.Assign(sent->tag, UnitRole::Minerals, mineral_target->tag, Observation()->GetGameLoop());
+			}
+		}
+		return;
+	}
+	expansion_drone_ = NullTag;
+
+	Point3D location;
+	if (!FindNextExpansion(location)) {
+		return;
+	}
+
+	const Unit *drone = nullptr;
+	for (const auto &candidate : CurrentUnits().OfType(UNIT_TYPEID::ZERG_DRONE)) {
+		if (!candidate->orders.empty() && IsAvailableWorker(candidate)) {
+			drone = candidate;
+			break;
+		}
+	}
+	if (!drone) {
+		return;
+	}
+
+	float travel_time = Distance2D(drone->pos, location) / kDroneSpeed;
+	if (forecaster_.CanAffordWithin(hatchery.minerals, hatchery.vespene, travel_time)) { // Arrive as the hatchery becomes affordable
+		Command(TraceSource::PrepareExpansion, TraceReason::Expand, drone, ABILITY_ID::MOVE, location);
+		units_.Assign(drone->tag, UnitRole::Builder, NullTag, Observation()->GetGameLoop());
+		expansion_drone_ = drone->tag;
+		expansion_location_ = location;
+	}
+}
+
 bool BasicSc2Bot::TryUpgradeBase() {
 	Units hatcheries = GetUnitsOfType(UNIT_TYPEID::ZERG_HATCHERY);
 	Units lairs = GetUnitsOfType(UNIT_TYPEID::ZERG_LAIR);
@@ -733,9 +1058,9 @@ bool BasicSc2Bot::TryUpgradeBase() {
 		if (hatchery->build_progress < 1.0f) { // Skip if hatchery incomplete
 			continue;
 		}
-		if (Observation()->GetMinerals() >= 150 && Observation()->GetVespene() >= 100) {
+		if (CanAfford(UnitData(UNIT_TYPEID::ZERG_LAIR))) {
 			if (!GetUnitsOfType(UNIT_TYPEID::ZERG_SPAWNINGPOOL).empty()) {
-				Actions()->UnitCommand(hatchery, ABILITY_ID::MORPH_LAIR);
+				Command(TraceSource::TryUpgradeBase, TraceReason::Tech, hatchery, ABILITY_ID::MORPH_LAIR);
 				return true;
 			}
 		}
@@ -745,9 +1070,9 @@ bool BasicSc2Bot::TryUpgradeBase() {
 		if (lair->build_progress < 1.0f) { // Skip lair incomplete
 			continue;
 		}
-		if (Observation()->GetMinerals() >= 200 && Observation()->GetVespene() >= 150) {
+		if (CanAfford(UnitData(UNIT_TYPEID::ZERG_HIVE))) {
 			if (!GetUnitsOfType(UNIT_TYPEID::ZERG_INFESTATIONPIT).empty()) {
-				Actions()->UnitCommand(lair, ABILITY_ID::MORPH_HIVE);
+				Command(TraceSource::TryUpgradeBase, TraceReason::Tech, lair, ABILITY_ID::MORPH_HIVE);
 				return true;
 			}
 		}
@@ -760,23 +1085,218 @@ bool BasicSc2Bot::TryBuildStructure2(AbilityID build_ability, UnitTypeID worker_
 	const ObservationInterface *observation = Observation();
 
 	// Check resources before proceeding
-	if (observation->GetMinerals() < 300) {
+	if (!CanAfford(AbilityData(build_ability))) {
 		return false;
 	}
 
 	// Get available workers
-	Units workers = observation->GetUnits(
-	    Unit::Self, [worker_type](const Unit &unit) { return unit.unit_type == worker_type && (unit.orders.empty() || unit.orders[0].ability_id == ABILITY_ID::HARVEST_GATHER); });
+	Units workers = observation->GetUnits(Unit::Self, [this, worker_type](const Unit &unit) { return unit.unit_type == worker_type && IsAvailableWorker(&unit); });
 
 	if (workers.empty()) {
 		return false;
 	}
 
-	// Use the first available worker
-	const Unit *worker = workers.front();
+	// Prefer the drone sent ahead by PrepareExpansion, otherwise use the first available worker
+	const Unit *worker = observation->GetUnit(expansion_drone_);
+	if (!worker) {
+		worker = workers.front();
+	}
+	expansion_drone_ = NullTag;
 
 	// Stop the worker and issue the build command
-	Actions()->UnitCommand(worker, ABILITY_ID::STOP);
-	Actions()->UnitCommand(worker, build_ability, location);
+	Command(TraceSource::TryBuildStructure2, TraceReason::Expand, worker, ABILITY_ID::STOP);
+	Command(TraceSource::TryBuildStructure2, TraceReason::Expand, worker, build_ability, location);
+	units_.Assign(worker->tag, UnitRole::Builder, NullTag, observation->GetGameLoop());
+	return true;
+}
+bool BasicSc2Bot::ExecuteBuildOrder() {
+	if (build_order_index_ >= build_order_.size()) {
+		return false;
+	}
+
+	const BuildOrderStep &step = build_order_[build_order_index_];
+	if (Observation()->GetFoodUsed() >= step.supply && TryStartBuildOrderItem(step.item)) {
+		build_order_index_++;
+		build_order_stall_steps_ = 0;
+	} else if (++build_order_stall_steps_ > kBuildOrderStallSteps) { // Blocked for too long (lost tech, no drones), move on
+		build_order_index_++;
+		build_order_stall_steps_ = 0;
+	}
+
+	// The optimizer assumes gas saturation keeps running during the opener, injects run every step
+	AssignWorkersToExtractors();
+	BalanceWorkers();
+	return true;
+}
+
+bool BasicSc2Bot::TryStartBuildOrderItem(BuildOrderItem item) {
+	switch (item) {
+	case BuildOrderItem::Drone:
+		return TrainUnitFromLarvae(ABILITY_ID::TRAIN_DRONE);
+	case BuildOrderItem::Overlord:
+		return TrainUnitFromLarvae(ABILITY_ID::TRAIN_OVERLORD);
+	case BuildOrderItem::Zergling:
+		return HasCompletedStructure(UNIT_TYPEID::ZERG_SPAWNINGPOOL) && TrainUnitFromLarvae(ABILITY_ID::TRAIN_ZERGLING);
+	case BuildOrderItem::Roach:
+		return HasCompletedStructure(UNIT_TYPEID::ZERG_ROACHWARREN) && TrainUnitFromLarvae(ABILITY_ID::TRAIN_ROACH);
+	case BuildOrderItem::Hydralisk:
+		return HasCompletedStructure(UNIT_TYPEID::ZERG_HYDRALISKDEN) && TrainUnitFromLarvae(ABILITY_ID::TRAIN_HYDRALISK);
+	case BuildOrderItem::Mutalisk:
+		return HasCompletedStructure(UNIT_TYPEID::ZERG_SPIRE) && TrainUnitFromLarvae(ABILITY_ID::TRAIN_MUTALISK);
+	case BuildOrderItem::Queen: {
+		if (!HasCompletedStructure(UNIT_TYPEID::ZERG_SPAWNINGPOOL) || !CanAfford(UnitData(UNIT_TYPEID::ZERG_QUEEN))) {
+			return false;
+		}
+		for (const auto &base : GetActiveBases()) { // Any finished base that is not already training a queen
+			if (base->build_progress == 1.0f && base->orders.empty()) {
+				Command(TraceSource::TryStartBuildOrderItem, TraceReason::BuildOrder, base, ABILITY_ID::TRAIN_QUEEN);
+				return true;
+			}
+		}
+		return false;
+	}
+	case BuildOrderItem::Hatchery:
+		return TryExpand(ABILITY_ID::BUILD_HATCHERY, UNIT_TYPEID::ZERG_DRONE);
+	case BuildOrderItem::Extractor:
+		return CanAfford(UnitData(UNIT_TYPEID::ZERG_EXTRACTOR)) && TryBuildVespeneExtractor();
+	case BuildOrderItem::SpawningPool:
+		if (TryBuildStructure(UNIT_TYPEID::ZERG_SPAWNINGPOOL)) {
+			once = false; // Default logic should not place a second pool
+			return true;
+		}
+		return false;
+	case BuildOrderItem::RoachWarren:
+		return HasCompletedStructure(UNIT_TYPEID::ZERG_SPAWNINGPOOL) && TryBuildStructure(UNIT_TYPEID::ZERG_ROACHWARREN);
+	case BuildOrderItem::Lair:
+		return HasCompletedStructure(UNIT_TYPEID::ZERG_SPAWNINGPOOL) && TryUpgradeBase();
+	case BuildOrderItem::HydraliskDen:
+		return HasCompletedStructure(UNIT_TYPEID::ZERG_LAIR) && TryBuildStructure(UNIT_TYPEID::ZERG_HYDRALISKDEN);
+	case BuildOrderItem::Spire:
+		return HasCompletedStructure(UNIT_TYPEID::ZERG_LAIR) && TryBuildStructure(UNIT_TYPEID::ZERG_SPIRE);
+	default:
+		return false;
+	}
+}
+
+bool BasicSc2Bot::HasCompletedStructure(UNIT_TYPEID structure) {
+	for (const auto &unit : GetUnitsOfType(structure)) {
+		if (unit->build_progress == 1.0f) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void BasicSc2Bot::RunAnalysisPhase() {
+	if (!pipelined_) {
+		BuildSnapshot();
+		RunStepAnalysis(*analysis_pool_, snapshot_, analysis_);
+		analysis_nanoseconds_ += analysis_.WallNanoseconds();
+		return;
+	}
+
+	// Pipelined: the analysis of the previous snapshot ran while the game simulated this step. Its
+	// results are one step stale, which is safe because the commit phase only reads positions and
+	// tags from them and re-resolves every tag against the current observation.
+	{
+		ScopedTimer wait_timer(wait_nanoseconds_);
+		analysis_pool_->Wait();
+	}
+	std::swap(analysis_, pending_analysis_);
+	analysis_nanoseconds_ += analysis_.WallNanoseconds();
+
+	BuildSnapshot(); // Safe to overwrite, no task reads it any more
+	SubmitStepAnalysis(*analysis_pool_, snapshot_, pending_analysis_);
+}
+
+void BasicSc2Bot::BuildSnapshot() { BuildStepSnapshot(CurrentUnits().All(), Observation()->GetGameLoop(), startLocation_, snapshot_); }
+
+bool BasicSc2Bot::EnableMetrics(int port) {
+	if (!metrics_.Start(port)) {
+		std::cout << "Could not serve metrics on port " << port << std::endl;
+		return false;
+	}
+	std::cout << "Serving metrics on http://127.0.0.1:" << port << "/metrics" << std::endl;
+	return true;
+}
+
+void BasicSc2Bot::PublishMetrics(int64_t step_nanoseconds) {
+	const ObservationInterface *observation = Observation();
+	metrics_.Set(MetricGauge::MineralRate, forecaster_.MineralRate());
+	metrics_.Set(MetricGauge::VespeneRate, forecaster_.VespeneRate());
+	metrics_.Set(MetricGauge::Minerals, observation->GetMinerals());
+	metrics_.Set(MetricGauge::Vespene, observation->GetVespene());
+	metrics_.Set(MetricGauge::SupplyUsed, observation->GetFoodUsed());
+	metrics_.Set(MetricGauge::SupplyCap, observation->GetFoodCap());
+	metrics_.Set(MetricGauge::Larva, forecaster_.Larva());
+	metrics_.Set(MetricGauge::TraceQueue, static_cast<double>(trace_.Pending()));
+	metrics_.Set(MetricGauge::AnalysisQueue, analysis_pool_ ? analysis_pool_->Queued() : 0);
+	metrics_.Set(MetricGauge::BuildOrderLeft, static_cast<double>(build_order_.size() - std::min(build_order_index_, build_order_.size())));
+	metrics_.RecordStep(step_nanoseconds, observation->GetGameLoop());
+}
+
+bool BasicSc2Bot::EnableTrace(const std::string &path) {
+	if (!trace_.Open(path)) {
+		std::cout << "Could not open decision trace " << path << std::endl;
+		return false;
+	}
 	return true;
-}
\ No newline at end of file
+}
+
+void BasicSc2Bot::Command(TraceSource source, TraceReason reason, const Unit *unit, AbilityID ability) {
+	Actions()->UnitCommand(unit, ability);
+	TraceCommand(source, reason, unit, ability, unit->pos);
+}
+
+void BasicSc2Bot::Command(TraceSource source, TraceReason reason, const Unit *unit, AbilityID ability, const Point2D &point) {
+	Actions()->UnitCommand(unit, ability, point);
+	TraceCommand(source, reason, unit, ability, point);
+}
+
+void BasicSc2Bot::Command(TraceSource source, TraceReason reason, const Unit *unit, AbilityID ability, const Unit *target) {
+	Actions()->UnitCommand(unit, ability, target);
+	TraceCommand(source, reason, unit, ability, target->pos);
+}
+
+void BasicSc2Bot::Command(TraceSource source, TraceReason reason, const Units &units, AbilityID ability, const Point2D &point) {
+	Actions()->UnitCommand(units, ability, point); // One action for the whole group
+	for (const auto &unit : units) {
+		TraceCommand(source, reason, unit, ability, point);
+	}
+}
+
+void BasicSc2Bot::TraceCommand(TraceSource source, TraceReason reason, const Unit *unit, AbilityID ability, const Point2D &target) {
+	metrics_.RecordAction(); // Every Command ends up here
+	if (!trace_.IsOpen()) { // Tracing off costs one branch per action
+		return;
+	}
+
+	auto trace_start = std::chrono::steady_clock::now();
+	const ObservationInterface *observation = Observation();
+	TraceRecord record = {};
+	record.game_loop = observation->GetGameLoop();
+	record.step_micros = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(trace_start - step_start_).count());
+	record.unit_tag = unit->tag;
+	record.ability_id = static_cast<uint32_t>(ability.ToType());
+	record.target_x = target.x;
+	record.target_y = target.y;
+	record.minerals = observation->GetMinerals();
+	record.vespene = observation->GetVespene();
+	record.supply_used = static_cast<uint16_t>(observation->GetFoodUsed());
+	record.supply_cap = static_cast<uint16_t>(observation->GetFoodCap());
+	record.source = static_cast<uint8_t>(source);
+	record.reason = static_cast<uint8_t>(reason);
+	trace_.Record(record);
+	trace_nanoseconds_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_start).count();
+}
+
+TraceReason BasicSc2Bot::LarvaTraceReason(ABILITY_ID unit_ability) {
+	switch (unit_ability) {
+	case ABILITY_ID::TRAIN_DRONE:
+		return TraceReason::Economy;
+	case ABILITY_ID::TRAIN_OVERLORD:
+		return TraceReason::Supply;
+	default:
+		return TraceReason::Army;
+	}
+}
@@ -7,11 +7,34 @@
 #include "sc2utils/sc2_arg_parser.h"
 #include "sc2utils/sc2_manage_process.h"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <sc2api/sc2_typeenums.h>
 #include <sc2api/sc2_unit.h>
 
+#include "BileTargeting.h"
+#include "BuildOrder.h"
+#include "CreepGrid.h"
+#include "DecisionTrace.h"
+#include "MacroForecaster.h"
+#include "MapRegions.h"
+#include "MetricsServer.h"
+#include "ObservationStats.h"
+#include "QueenManager.h"
+#include "ScoutPlanner.h"
+#include "SquadManager.h"
+#include "StepAnalysis.h"
+#include "StepUnits.h"
+#include "ThreadPool.h"
+#include "UnitQueries.h"
+#include "UnitRegistry.h"
+#include "VisibilityGrid.h"
+#include "ZergData.h"
+
 using namespace sc2;
 
 class BasicSc2Bot : public sc2::Agent {
@@ -19,44 +42,132 @@ class BasicSc2Bot : public sc2::Agent {
 	virtual void OnGameStart();
 	virtual void OnStep();
 	virtual void OnUnitIdle(const Unit *unit);
+	virtual void OnUnitCreated(const Unit *unit);
+	virtual void OnBuildingConstructionComplete(const Unit *unit);
+	virtual void OnUnitDestroyed(const Unit *unit);
+	virtual void OnGameEnd();
+
+	void SetPipelined(bool pipelined) { pipelined_ = pipelined; } // Overlap the analysis phase with the game simulation
+	bool EnableTrace(const std::string &path);                     // Record every issued action to a binary trace file
+	bool EnableMetrics(int port);                                  // Serve live metrics on a local HTTP port
 
   private:
+	void StepBot(); // Bot logic of OnStep, which adds timing and tracing around it
+
+	// Issue an action and record it in the decision trace
+	void Command(TraceSource source, TraceReason reason, const Unit *unit, AbilityID ability);
+	void Command(TraceSource source, TraceReason reason, const Unit *unit, AbilityID ability, const Point2D &point);
+	void Command(TraceSource source, TraceReason reason, const Unit *unit, AbilityID ability, const Unit *target);
+	void Command(TraceSource source, TraceReason reason, const Units &units, AbilityID ability, const Point2D &point);
+	void TraceCommand(TraceSource source, TraceReason reason, const Unit *unit, AbilityID ability, const Point2D &target);
+	static TraceReason LarvaTraceReason(ABILITY_ID unit_ability);
+	DecisionTrace trace_;
+	void PublishMetrics(int64_t step_nanoseconds);
+	MetricsServer metrics_;
+	std::chrono::steady_clock::time_point step_start_;
+
 	const Unit *FindNearestMineralPatch(const Point2D &start);
 	const Unit *FindNearestVespenseGeyser(const Point2D &start);
 	Units GetUnitsOfType(UNIT_TYPEID type); // Retrieves units of the specified type
+	const StepUnits &CurrentUnits();        // Units of this observation, fetched from the API once per game loop
+	StepUnits step_units_;
+#if defined(BASICSC2BOT_OBSERVATION_STATS)
+	ObservationStats observation_stats_;
+#endif
 
 	void AssignWorkersToExtractors();                                                                                     // Assign workers to vespene extractors
 	bool TryBuildVespeneExtractor();                                                                                      // Creates a Vespene Extractor at the closest location
 	bool TryTrainOverlord();                                                                                              // Handles Zerg supply management
-	bool QueenInjectLarvae();                                                                                             // Manages larvae injection using Queens
-	bool TrainUnitFromLarvae(ABILITY_ID unit_ability, int mineral_cost, int vespene_cost = 0);                            // Trains units from larvae
+	bool QueenInjectLarvae();                                                                                             // Issues the injects the queen manager predicts and replaces missing queens
+	bool CanAfford(const ZergUnitData &data);                                                                             // Enough minerals and gas for one order
+	bool TrainUnitFromLarvae(ABILITY_ID unit_ability);                                                                    // Trains units from larvae
 	bool TryUpgradeBase();                                                                                                // For upgrading base to Lair, Hive
-	bool TryBuildStructure(ABILITY_ID build_structure, UNIT_TYPEID structure_id, int mineral_cost, int vespene_cost = 0); // Build Structure
+	bool TryBuildStructure(UNIT_TYPEID structure_id);                                                                     // Build Structure
+
+	UnitRegistry units_;                         // Role of each unit, so subsystems never grab the same drone
+	bool IsAvailableWorker(const Unit *drone);   // Mining or idle and not claimed as a builder or gas worker
 
-	bool HasQueenAssigned(const Unit *base); // Checks if a Queen is assigned to a base
+	QueenManager queen_manager_; // Queen to hatchery bindings and inject timers
+	std::vector<InjectOrder> injects_;
+
+	bool ExecuteBuildOrder();                          // Follows the loaded opener, returns false once it is done
+	bool TryStartBuildOrderItem(BuildOrderItem item);  // Starts one opener item if affordable
+	bool HasCompletedStructure(UNIT_TYPEID structure); // Checks if at least one structure of the type is finished
+	std::vector<BuildOrderStep> build_order_;          // Opener loaded from the optimizer output
+	size_t build_order_index_ = 0;
+	int build_order_stall_steps_ = 0;
 
 	std::vector<Point3D> expansions_;
+	std::vector<float> expansion_distances_; // Ground distance from the start location, per expansion
+	MapRegions regions_;                     // Regions and chokes of the map, built at game start
 	bool TryExpand(AbilityID build_ability, UnitTypeID worker_type);
+	bool FindNextExpansion(Point3D &location); // Closest expansion without a base, no placement query
+	void PrepareExpansion();                   // Sends a drone ahead when the forecast says the hatchery is affordable on arrival
+	Tag expansion_drone_ = NullTag;
+	Point3D expansion_location_;               // Where expansion_drone_ was sent
 	bool TryBuildStructure2(AbilityID build_ability, UnitTypeID worker_type, const Point3D &location, bool check_placement);
 	Point3D startLocation_;
 	int GetExpectedWorkers();
 
 	void BalanceWorkers(); // Balances workers among bases
+	std::vector<BaseSaturation> oversaturated_bases_;
+	std::vector<WorkerTransfer> worker_transfers_;
 
-	void ManageArmy();                        // Function to manage army units and attack
-	void AttackWithArmy();                    // Function to order the army to attack
+	void ManageArmy();                        // Adds new combat units to squads and orders each squad
+	void OrderSquad(SquadRole role, const Point2D &target, TraceSource source, TraceReason reason);
+	void AttackWithArmy();                    // Sends the main squad at the closest enemy or the next known base
+	SquadManager squads_;                     // Main, harass and defense squads
+	Units squad_units_;                       // Members to order, reused between squads
 	bool TrainArmyUnits();                    // Trains army units based on available tech structures
+	bool NextTechCost(int &mineral_cost, int &vespene_cost); // Cost of the next structure TryBuildTechStructuresAndUpgrades will build
+	bool ShouldSaveForTech();                 // True when larva spending would delay tech the forecast says is close
 	void TryBuildTechStructuresAndUpgrades(); // Builds tech structures and researches upgrades
 	Units GetActiveBases();                   // Returns a list of active bases (Hatcheries, Lairs, Hives)
 	int CountUnitType(UNIT_TYPEID unit_type);
 	std::vector<Point2D> enemy_base_locations_; // Possible enemy base locations
 	size_t current_target_index_;
-	bool IsCombatUnit(const Unit &unit); // Helper function to check if a unit is a combat unit
 	Point2D GetArmyRallyPoint();
+	void Scout();                  // Recruits overlords and spare zerglings and sends them to the stalest sites
+	void AddScoutSites();          // Expansions and enemy starts, once the expansions are known
+	VisibilityGrid visibility_;    // Visible tiles and how long the others have been out of sight
+	ScoutPlanner scouts_;
+	std::vector<ScoutOrder> scout_orders_;
 	void MorphRoachesToRavagers(); // Morphs roaches to ravagers
+	void CastCorrosiveBile();      // Biles the densest enemy clusters in range of each ravager
+	BileTargeting bile_;
+	std::vector<BileCast> bile_casts_;
 	bool once = true;
 	bool expansion_once = true;
 	int step_counter = 0;
+	MacroForecaster forecaster_; // Projects resources and supply for overlord, expansion and tech timing
+
+	struct TumorCast {
+		Point2D spot;       // Where the child was sent
+		uint32_t game_loop; // When the spread was commanded
+	};
+	void SpreadCreep();                               // Plants creep tumors with spare queen energy and spreads existing tumors
+	CreepGrid creep_;                                 // Creep layer, updated every step from the raw map state
+	std::unordered_set<Tag> spent_tumors_;            // Tumors that already spawned their one child
+	std::unordered_map<Tag, TumorCast> tumor_casts_; // Spread commands waiting for the order or the child to show up
+	std::vector<Point2D> tumor_positions_;            // Tumors and planned tumors, planning keeps new spots away from them
+	std::vector<Point2D> tumor_spots_;
+
+	void RunAnalysisPhase();
+	void BuildSnapshot();                       // Fills snapshot_ from the observation, game thread only
+	StepSnapshot snapshot_;
+	StepAnalysis analysis_;         // Results consumed by the commit phase, one step stale when pipelined
+	StepAnalysis pending_analysis_; // Pipelined only, being computed while the game simulates
+	// Runs the read-only analysis phase of OnStep. Declared after what its tasks read and write, so
+	// it is destroyed first and waits for a pipelined analysis still in flight.
+	std::unique_ptr<ThreadPool> analysis_pool_;
+
+	bool pipelined_ = false;
+	std::chrono::steady_clock::time_point first_step_time_;
+	int timed_steps_ = 0;
+	int64_t step_nanoseconds_ = 0;     // Time spent inside OnStep
+	int64_t analysis_nanoseconds_ = 0; // Wall time from submitting the analysis until its last task finished
+	int64_t wait_nanoseconds_ = 0;     // Time OnStep waited for background analysis
+	int64_t trace_nanoseconds_ = 0;    // Time spent building and recording trace records
 };
 
 #endif
\ No newline at end of file
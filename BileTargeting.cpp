@@ -0,0 +1,252 @@
+#include "BileTargeting.h"
+
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BILE_TARGETING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+const float kBileRange = 9.0f;           // Cast range from the ravager
+const float kBileRadius = 0.5f;          // Splash radius around the landing spot
+const float kTargetRange = 12.0f;        // Enemies this close to a ravager are loaded, the splash reaches a bit past the cast range
+const float kBileSpacing = 1.5f;         // Biles closer than this mostly hit the same units
+const uint32_t kBileCooldownLoops = 157; // 7 seconds
+const uint32_t kBileDelayLoops = 56;     // 2.5 seconds from the cast until it lands
+const float kMinBileScore = 2.0f;        // Two moving targets or one that stands still
+const float kStationaryDistance = 0.1f;  // Moved less than this since the last plan
+const float kStationaryWeight = 2.0f;
+const float kSiegedWeight = 3.0f; // Cannot walk out of the splash at all
+
+bool IsSieged(UNIT_TYPEID type) {
+	switch (type) {
+	case UNIT_TYPEID::TERRAN_SIEGETANKSIEGED:
+	case UNIT_TYPEID::TERRAN_WIDOWMINEBURROWED:
+	case UNIT_TYPEID::TERRAN_LIBERATORAG:
+	case UNIT_TYPEID::ZERG_LURKERMPBURROWED:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool IsCastingBile(const Unit *ravager) {
+	for (const auto &order : ravager->orders) {
+		if (order.ability_id == ABILITY_ID::EFFECT_CORROSIVEBILE) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TagLess(const std::pair<Tag, Point2D> &a, const std::pair<Tag, Point2D> &b) { return a.first < b.first; }
+} // namespace
+
+void BileTargeting::Reset() {
+	positions_.clear();
+	previous_positions_.clear();
+	cooldowns_.clear();
+	in_flight_.clear();
+}
+
+void BileTargeting::Plan(const Units &ravagers, const Units &enemies, uint32_t game_loop, std::vector<BileCast> &casts) {
+	casts.clear();
+	if (ravagers.empty()) {
+		return;
+	}
+	cooldowns_.erase(std::remove_if(cooldowns_.begin(), cooldowns_.end(),
+	                                [game_loop](const std::pair<Tag, uint32_t> &cooldown) { return game_loop - cooldown.second >= kBileCooldownLoops; }),
+	                 cooldowns_.end());
+	in_flight_.erase(std::remove_if(in_flight_.begin(), in_flight_.end(),
+	                                [game_loop](const std::pair<Point2D, uint32_t> &bile) { return game_loop - bile.second >= kBileDelayLoops; }),
+	                 in_flight_.end());
+
+	LoadTargets(ravagers, enemies); // Also when no ravager is ready, so stationary targets stay known
+	ready_.clear();
+	for (const auto &ravager : ravagers) {
+		if (Ready(ravager->tag, game_loop) && !IsCastingBile(ravager)) {
+			ready_.push_back(ravager);
+		}
+	}
+	if (ready_.empty() || targets_ == 0) {
+		return;
+	}
+
+	candidates_.clear();
+	for (size_t i = 0; i < targets_; ++i) { // Every target in cast range is a candidate spot
+		Point2D pos(xs_[i], ys_[i]);
+		bool in_range = false;
+		for (const auto &ravager : ready_) {
+			if (DistanceSquared2D(ravager->pos, pos) <= kBileRange * kBileRange) {
+				in_range = true;
+				break;
+			}
+		}
+		if (!in_range) {
+			continue;
+		}
+		float score = HitsAt(pos.x, pos.y).weight;
+		if (score >= kMinBileScore) {
+			candidates_.push_back({score, pos});
+		}
+	}
+	std::sort(candidates_.begin(), candidates_.end(), [](const Candidate &a, const Candidate &b) { return a.score > b.score; });
+
+	size_t unassigned = ready_.size();
+	for (const auto &candidate : candidates_) {
+		if (unassigned == 0) {
+			break;
+		}
+		BileCast cast = {nullptr, candidate.pos, candidate.score};
+		Hits hits = HitsAt(candidate.pos.x, candidate.pos.y); // Weight is the candidate score, never zero
+		Point2D center(hits.x / hits.weight, hits.y / hits.weight); // One mean shift step toward the middle of the cluster
+		float center_score = HitsAt(center.x, center.y).weight;
+		if (center_score >= cast.score) {
+			cast.target = center;
+			cast.score = center_score;
+		}
+		if (Reserved(cast.target, casts)) {
+			continue;
+		}
+
+		float closest = kBileRange * kBileRange;
+		size_t closest_index = ready_.size();
+		for (size_t i = 0; i < ready_.size(); ++i) {
+			if (!ready_[i]) { // Already has a spot this plan
+				continue;
+			}
+			float distance = DistanceSquared2D(ready_[i]->pos, cast.target);
+			if (distance <= closest) {
+				closest = distance;
+				closest_index = i;
+			}
+		}
+		if (closest_index == ready_.size()) {
+			continue;
+		}
+		cast.ravager = ready_[closest_index];
+		ready_[closest_index] = nullptr;
+		unassigned--;
+		casts.push_back(cast);
+	}
+}
+
+void BileTargeting::Record(const BileCast &cast, uint32_t game_loop) {
+	cooldowns_.push_back(std::make_pair(cast.ravager->tag, game_loop));
+	in_flight_.push_back(std::make_pair(cast.target, game_loop));
+}
+
+void BileTargeting::LoadTargets(const Units &ravagers, const Units &enemies) {
+	previous_positions_.swap(positions_);
+	positions_.clear();
+	xs_.clear();
+	ys_.clear();
+	reaches_.clear();
+	weights_.clear();
+
+	for (const auto &enemy : enemies) {
+		if (enemy->display_type != Unit::DisplayType::Visible) { // Snapshots of structures in the fog may be gone
+			continue;
+		}
+		bool near = false;
+		for (const auto &ravager : ravagers) {
+			if (DistanceSquared2D(ravager->pos, enemy->pos) <= kTargetRange * kTargetRange) {
+				near = true;
+				break;
+			}
+		}
+		if (!near) {
+			continue;
+		}
+
+		Point2D pos = enemy->pos;
+		float weight = 1.0f;
+		if (IsSieged(enemy->unit_type)) {
+			weight = kSiegedWeight;
+		} else {
+			auto previous = std::lower_bound(previous_positions_.begin(), previous_positions_.end(), std::make_pair(enemy->tag, pos), TagLess);
+			if (previous != previous_positions_.end() && previous->first == enemy->tag &&
+			    DistanceSquared2D(previous->second, pos) < kStationaryDistance * kStationaryDistance) { // Buildings always end up here
+				weight = kStationaryWeight;
+			}
+		}
+		float reach = kBileRadius + enemy->radius;
+		positions_.push_back(std::make_pair(enemy->tag, pos));
+		xs_.push_back(pos.x);
+		ys_.push_back(pos.y);
+		reaches_.push_back(reach * reach);
+		weights_.push_back(weight);
+	}
+	std::sort(positions_.begin(), positions_.end(), TagLess);
+
+	targets_ = xs_.size();
+	size_t padded = (targets_ + 3) & ~static_cast<size_t>(3);
+	xs_.resize(padded, 0.0f);
+	ys_.resize(padded, 0.0f);
+	reaches_.resize(padded, 0.0f);
+	weights_.resize(padded, 0.0f);
+}
+
+BileTargeting::Hits BileTargeting::HitsAt(float x, float y) const {
+	size_t padded = xs_.size();
+#if defined(BILE_TARGETING_SSE2)
+	const __m128 spot_x = _mm_set1_ps(x);
+	const __m128 spot_y = _mm_set1_ps(y);
+	__m128 sum_weight = _mm_setzero_ps();
+	__m128 sum_x = _mm_setzero_ps();
+	__m128 sum_y = _mm_setzero_ps();
+	for (size_t i = 0; i < padded; i += 4) {
+		__m128 target_x = _mm_loadu_ps(&xs_[i]);
+		__m128 target_y = _mm_loadu_ps(&ys_[i]);
+		__m128 dx = _mm_sub_ps(target_x, spot_x);
+		__m128 dy = _mm_sub_ps(target_y, spot_y);
+		__m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		__m128 hit = _mm_cmple_ps(distance, _mm_loadu_ps(&reaches_[i]));
+		__m128 weight = _mm_and_ps(hit, _mm_loadu_ps(&weights_[i])); // Zero where the splash misses
+		sum_weight = _mm_add_ps(sum_weight, weight);
+		sum_x = _mm_add_ps(sum_x, _mm_mul_ps(weight, target_x));
+		sum_y = _mm_add_ps(sum_y, _mm_mul_ps(weight, target_y));
+	}
+	float lanes[3][4];
+	_mm_storeu_ps(lanes[0], sum_weight);
+	_mm_storeu_ps(lanes[1], sum_x);
+	_mm_storeu_ps(lanes[2], sum_y);
+	Hits hits = {lanes[0][0] + lanes[0][1] + lanes[0][2] + lanes[0][3], lanes[1][0] + lanes[1][1] + lanes[1][2] + lanes[1][3],
+	             lanes[2][0] + lanes[2][1] + lanes[2][2] + lanes[2][3]};
+#else
+	Hits hits = {0.0f, 0.0f, 0.0f};
+	for (size_t i = 0; i < padded; ++i) { // Branch free, so the compiler can vectorize it on its own
+		float dx = xs_[i] - x;
+		float dy = ys_[i] - y;
+		float weight = dx * dx + dy * dy <= reaches_[i] ? weights_[i] : 0.0f;
+		hits.weight += weight;
+		hits.x += weight * xs_[i];
+		hits.y += weight * ys_[i];
+	}
+#endif
+	return hits;
+}
+
+bool BileTargeting::Ready(Tag ravager, uint32_t game_loop) const {
+	for (const auto &cooldown : cooldowns_) {
+		if (cooldown.first == ravager && game_loop - cooldown.second < kBileCooldownLoops) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool BileTargeting::Reserved(const Point2D &spot, const std::vector<BileCast> &casts) const {
+	for (const auto &cast : casts) {
+		if (DistanceSquared2D(cast.target, spot) < kBileSpacing * kBileSpacing) {
+			return true;
+		}
+	}
+	for (const auto &bile : in_flight_) {
+		if (DistanceSquared2D(bile.first, spot) < kBileSpacing * kBileSpacing) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,64 @@
+#ifndef BILE_TARGETING_H
+#define BILE_TARGETING_H
+
+#include "sc2api/sc2_api.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace sc2;
+
+struct BileCast {
+	const Unit *ravager;
+	Point2D target;
+	float score; // Weighted targets inside the splash
+};
+
+// Picks Corrosive Bile landing spots for ravagers. Enemies near any ravager go into flat x, y,
+// reach and weight arrays, and every enemy position in cast range is scored by the weighted
+// targets the splash would cover, four targets per SSE2 instruction where the compiler has it.
+// The best spots then move once to the weighted center of what they hit. Targets that stood
+// still since the last plan, and sieged units, weigh more since the bile lands after a delay.
+// Spots too close to another bile planned or still in the air are skipped, so ravagers spread
+// their casts instead of stacking them.
+class BileTargeting {
+  public:
+	void Reset();
+
+	// Fills casts with at most one spot per ravager that is off cooldown, best spots first
+	void Plan(const Units &ravagers, const Units &enemies, uint32_t game_loop, std::vector<BileCast> &casts);
+	void Record(const BileCast &cast, uint32_t game_loop); // Call for every cast issued, starts its cooldown and reserves the spot
+
+  private:
+	struct Hits {
+		float weight;
+		float x; // Weighted sums of the positions hit
+		float y;
+	};
+	struct Candidate {
+		float score;
+		Point2D pos;
+	};
+
+	void LoadTargets(const Units &ravagers, const Units &enemies);
+	Hits HitsAt(float x, float y) const; // The density kernel, over every loaded target
+	bool Ready(Tag ravager, uint32_t game_loop) const;
+	bool Reserved(const Point2D &spot, const std::vector<BileCast> &casts) const;
+
+	// Targets, structure of arrays padded to a multiple of four with zero weights
+	std::vector<float> xs_;
+	std::vector<float> ys_;
+	std::vector<float> reaches_; // Squared distance from the spot that still hits, splash plus target radius
+	std::vector<float> weights_;
+	size_t targets_ = 0;
+
+	std::vector<std::pair<Tag, Point2D>> positions_;          // Enemy positions at the last plan, sorted by tag
+	std::vector<std::pair<Tag, Point2D>> previous_positions_; // Swapped with positions_ to keep both allocations
+	std::vector<std::pair<Tag, uint32_t>> cooldowns_;         // Ravager and the loop it cast on
+	std::vector<std::pair<Point2D, uint32_t>> in_flight_;     // Landing spot and the loop it was cast on
+	std::vector<Candidate> candidates_;
+	std::vector<const Unit *> ready_;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "BuildOrder.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace {
+const char *const kItemNames[] = {
+    "DRONE", "OVERLORD", "ZERGLING", "QUEEN", "ROACH", "HYDRALISK", "MUTALISK", "HATCHERY", "EXTRACTOR", "SPAWNINGPOOL", "ROACHWARREN", "LAIR", "HYDRALISKDEN", "SPIRE",
+};
+static_assert(sizeof(kItemNames) / sizeof(kItemNames[0]) == static_cast<size_t>(BuildOrderItem::Count), "Build order item names out of sync");
+} // namespace
+
+const char *BuildOrderItemName(BuildOrderItem item) {
+	if (item >= BuildOrderItem::Count) {
+		return "UNKNOWN";
+	}
+	return kItemNames[static_cast<int>(item)];
+}
+
+bool BuildOrderItemFromName(const std::string &name, BuildOrderItem &item) {
+	for (int i = 0; i < static_cast<int>(BuildOrderItem::Count); ++i) {
+		if (name == kItemNames[i]) {
+			item = static_cast<BuildOrderItem>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool LoadBuildOrder(const std::string &path, std::vector<BuildOrderStep> &steps) {
+	std::ifstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	std::vector<BuildOrderStep> loaded;
+	std::string line;
+	while (std::getline(file, line)) {
+		size_t comment = line.find('#');
+		if (comment != std::string::npos) { // Strip comments
+			line.erase(comment);
+		}
+		std::istringstream fields(line);
+		BuildOrderStep step;
+		std::string name;
+		if (!(fields >> step.supply)) { // Skip blank lines
+			continue;
+		}
+		if (!(fields >> name) || !BuildOrderItemFromName(name, step.item)) { // Reject the whole file on a malformed line
+			return false;
+		}
+		loaded.push_back(step);
+	}
+
+	steps.swap(loaded);
+	return true;
+}
+
+bool SaveBuildOrder(const std::string &path, const std::vector<BuildOrderStep> &steps, const std::string &header) {
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	if (!header.empty()) {
+		std::istringstream lines(header);
+		std::string line;
+		while (std::getline(lines, line)) {
+			file << "# " << line << "\n";
+		}
+	}
+	for (const auto &step : steps) {
+		file << step.supply << " " << BuildOrderItemName(step.item) << "\n";
+	}
+	return static_cast<bool>(file);
+}
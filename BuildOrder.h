@@ -0,0 +1,39 @@
+#ifndef BUILD_ORDER_H
+#define BUILD_ORDER_H
+
+#include <string>
+#include <vector>
+
+// Build order items shared by the bot and the offline optimizer (tools/BuildOrderOptimizer).
+// Kept free of sc2 headers so the optimizer can be built without the game API.
+enum class BuildOrderItem {
+	Drone,
+	Overlord,
+	Zergling,
+	Queen,
+	Roach,
+	Hydralisk,
+	Mutalisk,
+	Hatchery,
+	Extractor,
+	SpawningPool,
+	RoachWarren,
+	Lair,
+	HydraliskDen,
+	Spire,
+	Count
+};
+
+struct BuildOrderStep {
+	int supply;          // Supply used when the item should be started
+	BuildOrderItem item; // What to start
+};
+
+const char *BuildOrderItemName(BuildOrderItem item);
+bool BuildOrderItemFromName(const std::string &name, BuildOrderItem &item);
+
+// Text format, one step per line: "<supply> <ITEM_NAME>", '#' starts a comment
+bool LoadBuildOrder(const std::string &path, std::vector<BuildOrderStep> &steps);
+bool SaveBuildOrder(const std::string &path, const std::vector<BuildOrderStep> &steps, const std::string &header = "");
+
+#endif
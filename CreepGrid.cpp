@@ -0,0 +1,260 @@
+#include "CreepGrid.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+const float kTumorRadius = 10.0f;  // Creep a tumor spreads, in tiles
+const float kTumorSpacing = 5.0f;  // Closer tumors mostly cover the same ground
+const float kTowardWeight = 4.0f;  // Open tiles worth one tile of progress toward the target
+
+struct ReverseTable { // Image bytes hold the leftmost tile in the high bit, the grid in the low bit
+	ReverseTable() {
+		for (int i = 0; i < 256; ++i) {
+			int reversed = 0;
+			for (int bit = 0; bit < 8; ++bit) {
+				reversed |= ((i >> bit) & 1) << (7 - bit);
+			}
+			bits[i] = static_cast<uint8_t>(reversed);
+		}
+	}
+	uint8_t bits[256];
+};
+const ReverseTable kReverse;
+
+int PopCount(uint64_t word) { return static_cast<int>(std::bitset<64>(word).count()); }
+
+int LowestBit(uint64_t word) { // Word must not be zero
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+struct TumorCandidate {
+	float score;
+	Point2D pos;
+};
+} // namespace
+
+void CreepGrid::Reset(const GameInfo &game_info) {
+	width_ = game_info.width;
+	height_ = game_info.height;
+	words_per_row_ = (width_ + 63) / 64;
+	size_t words = static_cast<size_t>(words_per_row_) * height_;
+	creep_.assign(words, 0);
+	edge_.assign(words, 0);
+	decoded_.assign(words, 0);
+	dirty_rows_.assign(height_, 0);
+	changed_tiles_ = 0;
+	LoadImage(game_info.pathing_grid.data, game_info.pathing_grid.bits_per_pixel, pathable_);
+	LoadImage(game_info.placement_grid.data, game_info.placement_grid.bits_per_pixel, placeable_);
+}
+
+void CreepGrid::LoadImage(const std::string &data, int bits_per_pixel, std::vector<uint64_t> &bits) const {
+	bits.assign(static_cast<size_t>(words_per_row_) * height_, 0);
+	if (static_cast<int64_t>(data.size()) * 8 < static_cast<int64_t>(width_) * height_ * bits_per_pixel) { // Not this map's layer
+		return;
+	}
+
+	const uint8_t *pixels = reinterpret_cast<const uint8_t *>(data.data());
+	for (int row = 0; row < height_; ++row) {
+		uint64_t *words = &bits[(height_ - 1 - row) * words_per_row_]; // Image origin is the top left, the map origin the bottom left
+		if (bits_per_pixel == 1 && width_ % 8 == 0) { // Rows start on a byte, copy eight tiles at a time
+			const uint8_t *bytes = pixels + row * (width_ / 8);
+			for (int byte = 0; byte < width_ / 8; ++byte) {
+				words[byte >> 3] |= static_cast<uint64_t>(kReverse.bits[bytes[byte]]) << ((byte & 7) * 8);
+			}
+		} else if (bits_per_pixel == 1) {
+			for (int x = 0; x < width_; ++x) {
+				int index = row * width_ + x;
+				if ((pixels[index >> 3] >> (7 - (index & 7))) & 1) {
+					words[x >> 6] |= uint64_t(1) << (x & 63);
+				}
+			}
+		} else { // One byte per tile on older game versions
+			for (int x = 0; x < width_; ++x) {
+				if (pixels[row * width_ + x] != 0) {
+					words[x >> 6] |= uint64_t(1) << (x & 63);
+				}
+			}
+		}
+	}
+}
+
+bool CreepGrid::Update(const std::string &creep, int bits_per_pixel) {
+	changed_tiles_ = 0;
+	if (width_ == 0) {
+		return false;
+	}
+
+	LoadImage(creep, bits_per_pixel, decoded_);
+	for (int y = 0; y < height_; ++y) {
+		const uint64_t *old_row = &creep_[y * words_per_row_];
+		const uint64_t *new_row = &decoded_[y * words_per_row_];
+		int changed = 0;
+		for (int word = 0; word < words_per_row_; ++word) {
+			uint64_t diff = old_row[word] ^ new_row[word];
+			if (diff) {
+				changed += PopCount(diff);
+			}
+		}
+		dirty_rows_[y] = changed > 0;
+		changed_tiles_ += changed;
+	}
+	if (changed_tiles_ == 0) {
+		return false;
+	}
+
+	creep_.swap(decoded_);
+	for (int y = 0; y < height_; ++y) { // The edge of a row depends on the rows above and below
+		if (dirty_rows_[y] || (y > 0 && dirty_rows_[y - 1]) || (y + 1 < height_ && dirty_rows_[y + 1])) {
+			UpdateEdge(y);
+		}
+	}
+	return true;
+}
+
+void CreepGrid::UpdateEdge(int row) {
+	const uint64_t *creep = &creep_[row * words_per_row_];
+	const uint64_t *pathable = &pathable_[row * words_per_row_];
+	const uint64_t *placeable = &placeable_[row * words_per_row_];
+	uint64_t *edge = &edge_[row * words_per_row_];
+	for (int word = 0; word < words_per_row_; ++word) {
+		uint64_t open = pathable[word] & ~creep[word];
+		uint64_t open_before = word > 0 ? pathable[word - 1] & ~creep[word - 1] : 0;
+		uint64_t open_after = word + 1 < words_per_row_ ? pathable[word + 1] & ~creep[word + 1] : 0;
+		uint64_t neighbours = (open << 1) | (open_before >> 63) | (open >> 1) | (open_after << 63); // Left and right
+		if (row > 0) {
+			size_t below = (row - 1) * words_per_row_ + word;
+			neighbours |= pathable_[below] & ~creep_[below];
+		}
+		if (row + 1 < height_) {
+			size_t above = (row + 1) * words_per_row_ + word;
+			neighbours |= pathable_[above] & ~creep_[above];
+		}
+		edge[word] = creep[word] & placeable[word] & neighbours;
+	}
+}
+
+bool CreepGrid::HasCreep(int x, int y) const { return Valid(x, y) && Bit(creep_, x, y); }
+
+bool CreepGrid::HasCreep(const Point2D &point) const { return HasCreep(static_cast<int>(std::floor(point.x)), static_cast<int>(std::floor(point.y))); }
+
+bool CreepGrid::HasCreepFootprint(const Point2D &center, int size) const {
+	int left = static_cast<int>(std::floor(center.x - size * 0.5f + 0.5f));
+	int bottom = static_cast<int>(std::floor(center.y - size * 0.5f + 0.5f));
+	for (int y = bottom; y < bottom + size; ++y) {
+		for (int x = left; x < left + size; ++x) {
+			if (!HasCreep(x, y)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int CreepGrid::CreepTiles() const {
+	int tiles = 0;
+	for (uint64_t word : creep_) {
+		tiles += PopCount(word);
+	}
+	return tiles;
+}
+
+int CreepGrid::CountOpen(int row, int x0, int x1) const {
+	x0 = std::max(x0, 0);
+	x1 = std::min(x1, width_ - 1);
+	if (row < 0 || row >= height_ || x0 > x1) {
+		return 0;
+	}
+
+	int count = 0;
+	for (int word = x0 >> 6; word <= x1 >> 6; ++word) {
+		uint64_t mask = ~uint64_t(0);
+		if (word == x0 >> 6) {
+			mask &= ~uint64_t(0) << (x0 & 63);
+		}
+		if (word == x1 >> 6) {
+			mask &= ~uint64_t(0) >> (63 - (x1 & 63));
+		}
+		size_t index = row * words_per_row_ + word;
+		count += PopCount(pathable_[index] & ~creep_[index] & mask);
+	}
+	return count;
+}
+
+int CreepGrid::CoverageAt(int x, int y) const {
+	int radius = static_cast<int>(kTumorRadius);
+	int coverage = 0;
+	for (int dy = -radius; dy <= radius; ++dy) { // One masked popcount per row of the disc
+		int half_width = static_cast<int>(std::sqrt(static_cast<float>(radius * radius - dy * dy)));
+		coverage += CountOpen(y + dy, x - half_width, x + half_width);
+	}
+	return coverage;
+}
+
+void CreepGrid::PlanTumors(const Point2D &origin, float range, const Point2D &toward, const std::vector<Point2D> &avoid, int count, std::vector<Point2D> &spots) const {
+	if (width_ == 0 || count <= 0) {
+		return;
+	}
+
+	std::vector<TumorCandidate> candidates;
+	float origin_progress = Distance2D(origin, toward);
+	int x0 = std::max(static_cast<int>(origin.x - range), 0);
+	int x1 = std::min(static_cast<int>(origin.x + range), width_ - 1);
+	int y0 = std::max(static_cast<int>(origin.y - range), 0);
+	int y1 = std::min(static_cast<int>(origin.y + range), height_ - 1);
+	for (int y = y0; y <= y1; ++y) {
+		for (int word = x0 >> 6; word <= x1 >> 6; ++word) {
+			uint64_t bits = edge_[y * words_per_row_ + word];
+			while (bits) { // Visit only the edge tiles of the word
+				int x = (word << 6) + LowestBit(bits);
+				bits &= bits - 1;
+				Point2D pos(x + 0.5f, y + 0.5f);
+				if (x < x0 || x > x1 || DistanceSquared2D(pos, origin) > range * range) {
+					continue;
+				}
+				bool crowded = false;
+				for (const auto &other : avoid) {
+					if (DistanceSquared2D(pos, other) < kTumorSpacing * kTumorSpacing) {
+						crowded = true;
+						break;
+					}
+				}
+				if (crowded) {
+					continue;
+				}
+				int coverage = CoverageAt(x, y);
+				if (coverage > 0) {
+					candidates.push_back({coverage + kTowardWeight * (origin_progress - Distance2D(pos, toward)), pos});
+				}
+			}
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const TumorCandidate &a, const TumorCandidate &b) { return a.score > b.score; });
+	size_t first_spot = spots.size();
+	for (const auto &candidate : candidates) {
+		bool crowded = false;
+		for (size_t i = first_spot; i < spots.size(); ++i) {
+			if (DistanceSquared2D(candidate.pos, spots[i]) < kTumorSpacing * kTumorSpacing) {
+				crowded = true;
+				break;
+			}
+		}
+		if (!crowded) {
+			spots.push_back(candidate.pos);
+			if (static_cast<int>(spots.size() - first_spot) >= count) {
+				return;
+			}
+		}
+	}
+}
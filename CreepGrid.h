@@ -0,0 +1,52 @@
+#ifndef CREEP_GRID_H
+#define CREEP_GRID_H
+
+#include "sc2api/sc2_api.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace sc2;
+
+// Creep layer of the map as a packed bitset, one bit per tile and 64 tiles per word, rows padded
+// to whole words. Update compares the new layer with the stored one a word at a time and only
+// rebuilds the creep edge on rows that changed, so a step without creep changes is one pass over
+// width * height / 64 words.
+class CreepGrid {
+  public:
+	void Reset(const GameInfo &game_info); // Sizes the grid and loads the static pathing and placement layers
+	bool Update(const std::string &creep, int bits_per_pixel); // Creep layer of the raw map state, returns true when any tile changed
+
+	bool HasCreep(int x, int y) const;
+	bool HasCreep(const Point2D &point) const;
+	bool HasCreepFootprint(const Point2D &center, int size) const; // Every tile under a size x size structure has creep
+	int ChangedTiles() const { return changed_tiles_; }           // Tiles that gained or lost creep in the last update
+	int CreepTiles() const;
+
+	// Adds up to count tumor spots on the creep edge within range of origin, best first. Spots score
+	// by the pathable ground without creep they would cover plus the progress they make toward
+	// 'toward', and keep their distance from the avoid positions and from each other.
+	void PlanTumors(const Point2D &origin, float range, const Point2D &toward, const std::vector<Point2D> &avoid, int count, std::vector<Point2D> &spots) const;
+
+  private:
+	bool Valid(int x, int y) const { return x >= 0 && y >= 0 && x < width_ && y < height_; }
+	bool Bit(const std::vector<uint64_t> &bits, int x, int y) const { return (bits[y * words_per_row_ + (x >> 6)] >> (x & 63)) & 1; }
+	void LoadImage(const std::string &data, int bits_per_pixel, std::vector<uint64_t> &bits) const; // Image rows start at the top of the map
+	void UpdateEdge(int row);
+	int CountOpen(int row, int x0, int x1) const; // Pathable tiles without creep in [x0, x1] of a row
+	int CoverageAt(int x, int y) const;            // Open tiles a tumor at (x, y) would spread to
+
+	int width_ = 0;
+	int height_ = 0;
+	int words_per_row_ = 0;
+	int changed_tiles_ = 0;
+	std::vector<uint64_t> creep_;
+	std::vector<uint64_t> pathable_;
+	std::vector<uint64_t> placeable_;
+	std::vector<uint64_t> edge_;    // Placeable creep tiles next to pathable ground without creep
+	std::vector<uint64_t> decoded_; // Next creep layer, swapped with creep_ to keep both allocations
+	std::vector<uint8_t> dirty_rows_;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "DecisionTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+const char *const kSourceNames[] = {
+    "Step",
+    "OnUnitIdle",
+    "TrainUnitFromLarvae",
+    "TryBuildStructure",
+    "TryBuildStructure2",
+    "TryBuildVespeneExtractor",
+    "AssignWorkersToExtractors",
+    "BalanceWorkers",
+    "QueenInjectLarvae",
+    "TryTrainOverlord",
+    "TryUpgradeBase",
+    "MorphRoachesToRavagers",
+    "AttackWithArmy",
+    "DefendAgainstThreat",
+    "PrepareExpansion",
+    "TryStartBuildOrderItem",
+    "SpreadCreep",
+    "ManageArmy",
+    "CastCorrosiveBile",
+    "Scout",
+};
+static_assert(sizeof(kSourceNames) / sizeof(kSourceNames[0]) == static_cast<size_t>(TraceSource::Count), "Trace source names out of sync");
+
+const char *const kReasonNames[] = {
+    "None",
+    "StepEnd",
+    "Idle",
+    "Upgrade",
+    "Economy",
+    "Supply",
+    "Army",
+    "Tech",
+    "Saturation",
+    "Morph",
+    "Defend",
+    "Attack",
+    "AttackKnownBase",
+    "QueenMissing",
+    "Inject",
+    "Expand",
+    "BuildOrder",
+    "Creep",
+    "Rally",
+    "Harass",
+    "Bile",
+    "Scout",
+    "Retreat",
+};
+static_assert(sizeof(kReasonNames) / sizeof(kReasonNames[0]) == static_cast<size_t>(TraceReason::Count), "Trace reason names out of sync");
+
+const size_t kWriteBatch = 256;                     // Records per fwrite
+const std::chrono::milliseconds kDrainInterval(5);  // Writer thread wakes up this often
+} // namespace
+
+const char *TraceSourceName(uint8_t source) { return source < static_cast<uint8_t>(TraceSource::Count) ? kSourceNames[source] : "Unknown"; }
+
+const char *TraceReasonName(uint8_t reason) { return reason < static_cast<uint8_t>(TraceReason::Count) ? kReasonNames[reason] : "Unknown"; }
+
+DecisionTrace::DecisionTrace() : head_(0), tail_(0), stop_(false) {}
+
+DecisionTrace::~DecisionTrace() { Close(); }
+
+bool DecisionTrace::Open(const std::string &path) {
+	Close();
+	file_ = std::fopen(path.c_str(), "wb");
+	if (!file_) {
+		return false;
+	}
+
+	TraceFileHeader header;
+	std::memcpy(header.magic, "SC2T", 4);
+	header.version = kTraceFileVersion;
+	header.record_size = sizeof(TraceRecord);
+	std::fwrite(&header, sizeof(header), 1, file_);
+
+	ring_.reset(new TraceRecord[kCapacity]);
+	head_.store(0);
+	tail_.store(0);
+	stop_.store(false);
+	dropped_ = 0;
+	writer_ = std::thread(&DecisionTrace::WriterLoop, this);
+	return true;
+}
+
+void DecisionTrace::Close() {
+	if (!file_) {
+		return;
+	}
+	stop_.store(true);
+	writer_.join(); // Drains whatever is left before exiting
+	std::fclose(file_);
+	file_ = nullptr;
+	ring_.reset();
+}
+
+void DecisionTrace::Record(const TraceRecord &record) {
+	uint64_t head = head_.load(std::memory_order_relaxed);
+	if (head - tail_.load(std::memory_order_acquire) >= kCapacity) { // Full, the writer is behind
+		++dropped_;
+		return;
+	}
+	ring_[head & kMask] = record;
+	head_.store(head + 1, std::memory_order_release);
+}
+
+size_t DecisionTrace::Drain() {
+	uint64_t tail = tail_.load(std::memory_order_relaxed);
+	uint64_t head = head_.load(std::memory_order_acquire);
+	size_t written = 0;
+	while (tail < head) {
+		// Write contiguous runs straight from the ring, the wrap point splits a run in two
+		uint64_t run = std::min<uint64_t>(std::min<uint64_t>(head - tail, kCapacity - (tail & kMask)), kWriteBatch);
+		std::fwrite(&ring_[tail & kMask], sizeof(TraceRecord), static_cast<size_t>(run), file_);
+		tail += run;
+		written += static_cast<size_t>(run);
+		tail_.store(tail, std::memory_order_release);
+	}
+	return written;
+}
+
+void DecisionTrace::WriterLoop() {
+	while (!stop_.load()) {
+		if (Drain() == 0) {
+			std::this_thread::sleep_for(kDrainInterval);
+		}
+	}
+	Drain();
+	std::fflush(file_);
+}
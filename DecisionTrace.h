@@ -0,0 +1,132 @@
+#ifndef DECISION_TRACE_H
+#define DECISION_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Function that issued a traced action. Append only, the values are stored in trace files.
+enum class TraceSource : uint8_t {
+	Step, // Not an action, marks the end of a step
+	OnUnitIdle,
+	TrainUnitFromLarvae,
+	TryBuildStructure,
+	TryBuildStructure2,
+	TryBuildVespeneExtractor,
+	AssignWorkersToExtractors,
+	BalanceWorkers,
+	QueenInjectLarvae,
+	TryTrainOverlord,
+	TryUpgradeBase,
+	MorphRoachesToRavagers,
+	AttackWithArmy,
+	DefendAgainstThreat,
+	PrepareExpansion,
+	TryStartBuildOrderItem,
+	SpreadCreep,
+	ManageArmy,
+	CastCorrosiveBile,
+	Scout,
+	Count
+};
+
+// Why the action was issued. Append only, the values are stored in trace files.
+enum class TraceReason : uint8_t {
+	None,
+	StepEnd,
+	Idle,
+	Upgrade,
+	Economy,
+	Supply,
+	Army,
+	Tech,
+	Saturation,
+	Morph,
+	Defend,
+	Attack,
+	AttackKnownBase,
+	QueenMissing,
+	Inject,
+	Expand,
+	BuildOrder,
+	Creep,
+	Rally,
+	Harass,
+	Bile,
+	Scout,
+	Retreat,
+	Count
+};
+
+// One fixed-size record per issued action, plus one StepEnd record per step
+struct TraceRecord {
+	uint32_t game_loop;
+	uint32_t step_micros; // Time into the step the action was issued at, the whole step for StepEnd
+	uint64_t unit_tag;
+	uint32_t ability_id;
+	float target_x;
+	float target_y;
+	int32_t minerals;
+	int32_t vespene;
+	uint16_t supply_used;
+	uint16_t supply_cap;
+	uint8_t source; // TraceSource
+	uint8_t reason; // TraceReason
+	uint8_t padding[6];
+};
+static_assert(sizeof(TraceRecord) == 48, "TraceRecord is part of the trace file format");
+
+// Trace file header, followed by TraceRecords in native byte order
+struct TraceFileHeader {
+	char magic[4]; // "SC2T"
+	uint32_t version;
+	uint32_t record_size;
+};
+
+const uint32_t kTraceFileVersion = 1;
+
+const char *TraceSourceName(uint8_t source);
+const char *TraceReasonName(uint8_t reason);
+
+// Records go into a lock-free single-producer ring buffer and a background thread drains it to
+// the file. Record never blocks or allocates, when the ring is full the record is dropped.
+class DecisionTrace {
+  public:
+	DecisionTrace();
+	~DecisionTrace();
+
+	DecisionTrace(const DecisionTrace &) = delete;
+	DecisionTrace &operator=(const DecisionTrace &) = delete;
+
+	bool Open(const std::string &path);
+	void Close(); // Flushes everything recorded so far
+	bool IsOpen() const { return file_ != nullptr; }
+
+	void Record(const TraceRecord &record); // Producer side, call from a single thread
+	uint64_t Dropped() const { return dropped_; }
+	uint64_t Pending() const { return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_relaxed); } // Records not yet written
+
+  private:
+	static const uint64_t kCapacity = 1 << 14; // Power of two, 768 KB of records
+	static const uint64_t kMask = kCapacity - 1;
+
+	void WriterLoop();
+	size_t Drain(); // Consumer side, returns the number of records written
+
+	std::unique_ptr<TraceRecord[]> ring_;
+	// Padding keeps the producer and consumer indices on separate cache lines. alignas would need
+	// C++17 aligned new, the bot is heap allocated.
+	std::atomic<uint64_t> head_; // Next slot to write, owned by the producer
+	char head_padding_[64];
+	std::atomic<uint64_t> tail_; // Next slot to read, owned by the writer thread
+	char tail_padding_[64];
+	std::atomic<bool> stop_;
+	uint64_t dropped_ = 0;
+	std::FILE *file_ = nullptr;
+	std::thread writer_;
+};
+
+#endif
@@ -1,4 +1,7 @@
 
+#include <chrono>
+#include <functional>
+
 std::string kDefaultMap = "BelshirVestigeLE.SC2Map";
 
 static sc2::Difficulty GetDifficultyFromString(const std::string &InDifficulty)
@@ -82,6 +85,9 @@ struct ConnectionOptions
 	sc2::Race ComputerRace;
 	std::string OpponentId;
 	std::string Map;
+	bool Pipelined;
+	std::string TraceFile;
+	int32_t MetricsPort;
 };
 
 static void ParseArguments(int argc, char *argv[], ConnectionOptions &connect_options)
@@ -95,7 +101,10 @@ static void ParseArguments(int argc, char *argv[], ConnectionOptions &connect_op
 		{ "-a", "--ComputerRace", "Race of computer oppent"},
 		{ "-d", "--ComputerDifficulty", "Difficulty of computer oppenent"},
 		{ "-m", "--Map", "Map to play on against computer opponent", },
-		{ "-x", "--OpponentId", "PlayerId of opponent"}
+		{ "-x", "--OpponentId", "PlayerId of opponent"},
+		{ "-p", "--Pipelined", "Overlap bot planning with the game simulation" },
+		{ "-t", "--Trace", "Write a binary decision trace to this file" },
+		{ "-e", "--MetricsPort", "Serve live metrics on this local port" }
 		});
 	arg_parser.Parse(argc, argv);
 	std::string GamePortStr;
@@ -135,12 +144,22 @@ static void ParseArguments(int argc, char *argv[], ConnectionOptions &connect_op
 		connect_options.ComputerOpponent = false;
 	}
 	arg_parser.Get("OpponentId", connect_options.OpponentId);
+	std::string PipelinedStr;
+	connect_options.Pipelined = arg_parser.Get("Pipelined", PipelinedStr);
+	arg_parser.Get("Trace", connect_options.TraceFile);
+	std::string MetricsPortStr;
+	connect_options.MetricsPort = arg_parser.Get("MetricsPort", MetricsPortStr) ? atoi(MetricsPortStr.c_str()) : 0;
 }
 
-static void RunBot(int argc, char *argv[], sc2::Agent *Agent, sc2::Race race)
+// Configure lets the caller apply bot specific options before the game starts
+static void RunBot(int argc, char *argv[], sc2::Agent *Agent, sc2::Race race, const std::function<void(const ConnectionOptions &)> &Configure = nullptr)
 {
 	ConnectionOptions Options;
 	ParseArguments(argc, argv, Options);
+	if (Configure)
+	{
+		Configure(Options);
+	}
 
 	sc2::Coordinator coordinator;
 
@@ -170,6 +189,13 @@ static void RunBot(int argc, char *argv[], sc2::Agent *Agent, sc2::Race race)
 	}
 
 	coordinator.SetTimeoutMS(10000);
+	size_t steps = 0;
+	auto start = std::chrono::steady_clock::now();
 	while (coordinator.Update()) {
+		++steps;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (seconds > 0.0) {
+		std::cout << "Game loop: " << steps << " updates in " << seconds << "s (" << steps / seconds << " steps/s)" << std::endl;
 	}
 }
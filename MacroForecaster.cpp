@@ -0,0 +1,84 @@
+#include "MacroForecaster.h"
+
+#include <algorithm>
+
+namespace {
+const float kOverlordBuildTime = 18.0f; // Game seconds on faster speed
+const float kHatcheryBuildTime = 71.0f;
+const float kLarvaInterval = 11.0f;
+const int kNaturalLarvaCap = 3;
+const int kOverlordSupply = 8;
+const int kHatcherySupply = 6;
+const int kMaxSupply = 200;
+const int kLarvaMineralCost = 50; // Cheapest larva unit, a drone or a pair of zerglings for one supply
+} // namespace
+
+void MacroForecaster::Update(const ObservationInterface *observation) {
+	minerals_ = static_cast<float>(observation->GetMinerals());
+	vespene_ = static_cast<float>(observation->GetVespene());
+	const ScoreDetails &score = observation->GetScore().score_details; // Collection rates are per game minute
+	mineral_rate_ = score.collection_rate_minerals / 60.0f;
+	vespene_rate_ = score.collection_rate_vespene / 60.0f;
+	supply_used_ = observation->GetFoodUsed();
+	supply_cap_ = observation->GetFoodCap();
+	larva_ = 0;
+	hatcheries_ = 0;
+	pending_supply_.clear();
+
+	for (const auto &unit : observation->GetUnits(Unit::Alliance::Self)) {
+		switch (unit->unit_type.ToType()) {
+		case UNIT_TYPEID::ZERG_LARVA:
+			larva_++;
+			break;
+		case UNIT_TYPEID::ZERG_EGG:
+			for (const auto &order : unit->orders) {
+				if (order.ability_id == ABILITY_ID::TRAIN_OVERLORD) {
+					pending_supply_.push_back({(1.0f - order.progress) * kOverlordBuildTime, kOverlordSupply});
+				}
+			}
+			break;
+		case UNIT_TYPEID::ZERG_HATCHERY:
+			if (unit->build_progress < 1.0f) {
+				pending_supply_.push_back({(1.0f - unit->build_progress) * kHatcheryBuildTime, kHatcherySupply});
+			} else {
+				hatcheries_++;
+			}
+			break;
+		case UNIT_TYPEID::ZERG_LAIR:
+		case UNIT_TYPEID::ZERG_HIVE:
+			hatcheries_++;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+MacroForecast MacroForecaster::Project(float seconds) const {
+	MacroForecast forecast;
+	forecast.minerals = minerals_ + mineral_rate_ * seconds;
+	forecast.vespene = vespene_ + vespene_rate_ * seconds;
+
+	forecast.supply_cap = supply_cap_;
+	for (const auto &pending : pending_supply_) {
+		if (pending.seconds <= seconds) {
+			forecast.supply_cap += pending.supply;
+		}
+	}
+	forecast.supply_cap = std::min(forecast.supply_cap, kMaxSupply);
+
+	int spawned = hatcheries_ * static_cast<int>(seconds / kLarvaInterval); // Natural larva only, injects are a bonus
+	forecast.larva = std::max(larva_, std::min(larva_ + spawned, hatcheries_ * kNaturalLarvaCap));
+
+	// Assume every larva we can pay for turns into at least one supply
+	int affordable = static_cast<int>(forecast.minerals) / kLarvaMineralCost;
+	forecast.supply_used = supply_used_ + std::min(forecast.larva, affordable);
+	return forecast;
+}
+
+bool MacroForecaster::CanAffordWithin(int minerals, int vespene, float seconds) const {
+	MacroForecast forecast = Project(seconds);
+	return forecast.minerals >= minerals && forecast.vespene >= vespene;
+}
+
+void MacroForecaster::AddPendingSupply(float seconds, int supply) { pending_supply_.push_back({seconds, supply}); }
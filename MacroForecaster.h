@@ -0,0 +1,50 @@
+#ifndef MACRO_FORECASTER_H
+#define MACRO_FORECASTER_H
+
+#include "sc2api/sc2_api.h"
+
+#include <vector>
+
+using namespace sc2;
+
+struct MacroForecast {
+	float minerals;
+	float vespene;
+	int supply_used; // Includes the supply the projected larva will be spent on
+	int supply_cap;  // Includes overlords and hatcheries finishing within the horizon
+	int larva;       // Larva available over the horizon
+};
+
+// Projects resources and supply a few seconds ahead from the current income, production in
+// progress and larva. Update is one pass over our units, Project is O(production in progress),
+// so both are cheap enough to run every step.
+class MacroForecaster {
+  public:
+	void Update(const ObservationInterface *observation);
+	MacroForecast Project(float seconds) const;
+
+	bool CanAffordWithin(int minerals, int vespene, float seconds) const;
+	void AddPendingSupply(float seconds, int supply); // Supply ordered this step, not yet visible in the observation
+
+	float MineralRate() const { return mineral_rate_; }
+	float VespeneRate() const { return vespene_rate_; }
+	int Larva() const { return larva_; }
+
+  private:
+	struct PendingSupply {
+		float seconds; // Until the supply is provided
+		int supply;
+	};
+
+	float minerals_ = 0.0f;
+	float vespene_ = 0.0f;
+	float mineral_rate_ = 0.0f; // Per game second
+	float vespene_rate_ = 0.0f;
+	int supply_used_ = 0;
+	int supply_cap_ = 0;
+	int larva_ = 0;
+	int hatcheries_ = 0;
+	std::vector<PendingSupply> pending_supply_;
+};
+
+#endif
@@ -0,0 +1,371 @@
+#include "MapRegions.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+const float kInfinity = 1e20f;
+const float kMaxChokeRadius = 7.0f;   // Passages wider than 14 tiles are open ground
+const float kChokeRatio = 0.75f;      // A passage is a choke when it is this much narrower than the wide spots on both sides
+const int kMinRegionTiles = 100;      // Smaller basins are folded into a neighbour
+const float kChokeSeparation = 12.0f; // Saddles between the same two regions closer than this are one choke
+const int kExpansionSearch = 3;       // Tiles around an expansion searched for walkable ground
+
+bool ImageBit(const ImageData &image, int x, int row) {
+	int index = row * image.width + x;
+	const uint8_t *pixels = reinterpret_cast<const uint8_t *>(image.data.data());
+	if (image.bits_per_pixel == 1) {
+		return (pixels[index >> 3] >> (7 - (index & 7))) & 1;
+	}
+	return pixels[index] != 0; // One byte per tile on older game versions
+}
+
+bool ImageValid(const ImageData &image, int width, int height) {
+	return image.width == width && image.height == height && static_cast<int64_t>(image.data.size()) * 8 >= static_cast<int64_t>(width) * height * image.bits_per_pixel;
+}
+
+// Squared distance transform of one line, Felzenszwalb and Huttenlocher. v and z are scratch of
+// n and n + 1 entries.
+void Transform1D(const float *f, float *d, int n, int *v, float *z) {
+	int k = 0;
+	v[0] = 0;
+	z[0] = -kInfinity;
+	z[1] = kInfinity;
+	for (int q = 1; q < n; ++q) {
+		float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * (q - v[k]));
+		while (s <= z[k]) {
+			k--;
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * (q - v[k]));
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = kInfinity;
+	}
+	k = 0;
+	for (int q = 0; q < n; ++q) {
+		while (z[k + 1] < q) {
+			k++;
+		}
+		d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+	}
+}
+
+struct Saddle {
+	int tile;
+	float distance;
+	int a;
+	int b;
+};
+
+struct Basins { // Union-find over the regions the watershed grows, the root keeps the highest peak
+	int Add(float peak, int peak_tile) {
+		parent.push_back(static_cast<int>(parent.size()));
+		tiles.push_back(0);
+		peaks.push_back(peak);
+		peak_tiles.push_back(peak_tile);
+		return parent.back();
+	}
+	int Find(int basin) {
+		while (parent[basin] != basin) {
+			parent[basin] = parent[parent[basin]];
+			basin = parent[basin];
+		}
+		return basin;
+	}
+	void Merge(int a, int b) {
+		a = Find(a);
+		b = Find(b);
+		if (a == b) {
+			return;
+		}
+		if (peaks[a] < peaks[b]) {
+			std::swap(a, b);
+		}
+		parent[b] = a;
+		tiles[a] += tiles[b];
+	}
+
+	std::vector<int> parent;
+	std::vector<int> tiles;
+	std::vector<float> peaks;
+	std::vector<int> peak_tiles;
+};
+} // namespace
+
+void MapRegions::Build(const GameInfo &game_info, ThreadPool &pool) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	width_ = game_info.width;
+	height_ = game_info.height;
+	regions_.clear();
+	chokes_.clear();
+	choke_distances_.clear();
+	expansion_regions_.clear();
+	region_of_.assign(static_cast<size_t>(width_) * height_, -1);
+
+	const ImageData &pathing = game_info.pathing_grid;
+	const ImageData &placement = game_info.placement_grid;
+	if (width_ <= 0 || height_ <= 0 || !ImageValid(pathing, width_, height_)) {
+		return;
+	}
+	bool has_placement = ImageValid(placement, width_, height_);
+	std::vector<uint8_t> walkable(region_of_.size(), 0);
+	for (int row = 0; row < height_; ++row) {
+		int y = height_ - 1 - row; // Image origin is the top left, the map origin the bottom left
+		for (int x = 0; x < width_; ++x) { // Start locations and their minerals are not pathable yet, but placeable
+			walkable[y * width_ + x] = ImageBit(pathing, x, row) || (has_placement && ImageBit(placement, x, row));
+		}
+	}
+
+	ComputeDistances(walkable, pool);
+	Watershed(walkable);
+	ConnectChokes(game_info.enemy_start_locations.empty() ? Point2D() : game_info.enemy_start_locations.front());
+	build_milliseconds_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void MapRegions::ComputeDistances(const std::vector<uint8_t> &walkable, ThreadPool &pool) {
+	std::vector<float> columns(walkable.size());
+	distance_.assign(walkable.size(), 0.0f);
+	int chunks = static_cast<int>(pool.Size()) + 1;
+
+	// Columns and then rows, each line is independent so the lines are split over the pool
+	for (int chunk = 0; chunk < chunks; ++chunk) {
+		pool.Submit([this, chunk, chunks, &walkable, &columns] {
+			std::vector<float> f(height_), d(height_), z(height_ + 1);
+			std::vector<int> v(height_);
+			for (int x = width_ * chunk / chunks; x < width_ * (chunk + 1) / chunks; ++x) {
+				for (int y = 0; y < height_; ++y) {
+					f[y] = walkable[y * width_ + x] ? kInfinity : 0.0f;
+				}
+				Transform1D(f.data(), d.data(), height_, v.data(), z.data());
+				for (int y = 0; y < height_; ++y) {
+					columns[y * width_ + x] = d[y];
+				}
+			}
+		});
+	}
+	pool.Wait();
+
+	for (int chunk = 0; chunk < chunks; ++chunk) {
+		pool.Submit([this, chunk, chunks, &columns] {
+			std::vector<float> d(width_), z(width_ + 1);
+			std::vector<int> v(width_);
+			for (int y = height_ * chunk / chunks; y < height_ * (chunk + 1) / chunks; ++y) {
+				Transform1D(&columns[y * width_], d.data(), width_, v.data(), z.data());
+				for (int x = 0; x < width_; ++x) {
+					distance_[y * width_ + x] = std::sqrt(d[x]);
+				}
+			}
+		});
+	}
+	pool.Wait();
+}
+
+void MapRegions::Watershed(const std::vector<uint8_t> &walkable) {
+	std::vector<int> order;
+	for (int tile = 0; tile < static_cast<int>(walkable.size()); ++tile) {
+		if (walkable[tile]) {
+			order.push_back(tile);
+		}
+	}
+	std::sort(order.begin(), order.end(), [this](int a, int b) { return distance_[a] > distance_[b] || (distance_[a] == distance_[b] && a < b); });
+
+	// Flood from the widest spots down. A tile touching two basins is a saddle between them, and
+	// the basins stay apart when the saddle is a narrow passage between two wide spots.
+	Basins basins;
+	std::vector<int> basin_of(walkable.size(), -1);
+	std::vector<Saddle> saddles;
+	for (int tile : order) {
+		int x = tile % width_;
+		int y = tile / width_;
+		float distance = distance_[tile];
+		int neighbours[4] = {x > 0 ? tile - 1 : -1, x + 1 < width_ ? tile + 1 : -1, y > 0 ? tile - width_ : -1, y + 1 < height_ ? tile + width_ : -1};
+		int roots[4];
+		int count = 0;
+		for (int neighbour : neighbours) {
+			if (neighbour < 0 || basin_of[neighbour] < 0) {
+				continue;
+			}
+			int root = basins.Find(basin_of[neighbour]);
+			if (std::find(roots, roots + count, root) == roots + count) {
+				roots[count++] = root;
+			}
+		}
+
+		if (count == 0) { // Local maximum, a new basin
+			basin_of[tile] = basins.Add(distance, tile);
+			basins.tiles[basin_of[tile]]++;
+			continue;
+		}
+		int deepest = roots[0];
+		for (int i = 1; i < count; ++i) {
+			if (basins.peaks[roots[i]] > basins.peaks[deepest]) {
+				deepest = roots[i];
+			}
+		}
+		for (int i = 0; i < count; ++i) {
+			int a = basins.Find(deepest);
+			int b = basins.Find(roots[i]);
+			if (a == b) {
+				continue;
+			}
+			if (distance <= kMaxChokeRadius && distance < kChokeRatio * std::min(basins.peaks[a], basins.peaks[b])) {
+				saddles.push_back({tile, distance, a, b});
+			} else {
+				basins.Merge(a, b);
+			}
+		}
+		basin_of[tile] = basins.Find(deepest);
+		basins.tiles[basin_of[tile]]++;
+	}
+
+	bool merged = true;
+	while (merged) { // Fold small basins into the neighbour across their widest saddle
+		merged = false;
+		for (const auto &saddle : saddles) {
+			int a = basins.Find(saddle.a);
+			int b = basins.Find(saddle.b);
+			if (a != b && (basins.tiles[a] < kMinRegionTiles || basins.tiles[b] < kMinRegionTiles)) {
+				basins.Merge(a, b);
+				merged = true;
+			}
+		}
+	}
+
+	std::vector<int> region_index(basins.parent.size(), -1);
+	for (int tile : order) {
+		int root = basins.Find(basin_of[tile]);
+		if (region_index[root] < 0) {
+			region_index[root] = static_cast<int>(regions_.size());
+			MapRegion region;
+			int peak_tile = basins.peak_tiles[root];
+			region.center = Point2D(peak_tile % width_ + 0.5f, peak_tile / width_ + 0.5f);
+			region.radius = basins.peaks[root];
+			region.tiles = basins.tiles[root];
+			regions_.push_back(region);
+		}
+		region_of_[tile] = static_cast<int16_t>(region_index[root]);
+	}
+
+	// The first saddle found between two regions is the widest point of the passage, its middle.
+	// Later ones are the same passage unless they are far from it.
+	for (const auto &saddle : saddles) {
+		int a = region_index[basins.Find(saddle.a)];
+		int b = region_index[basins.Find(saddle.b)];
+		if (a == b) {
+			continue;
+		}
+		Point2D pos(saddle.tile % width_ + 0.5f, saddle.tile / width_ + 0.5f);
+		bool known = false;
+		for (const auto &choke : chokes_) {
+			bool same_pair = (choke.regions[0] == a && choke.regions[1] == b) || (choke.regions[0] == b && choke.regions[1] == a);
+			if (same_pair && DistanceSquared2D(choke.pos, pos) < kChokeSeparation * kChokeSeparation) {
+				known = true;
+				break;
+			}
+		}
+		if (!known) {
+			regions_[a].chokes.push_back(static_cast<int>(chokes_.size()));
+			regions_[b].chokes.push_back(static_cast<int>(chokes_.size()));
+			chokes_.push_back({pos, 2.0f * saddle.distance, {a, b}});
+		}
+	}
+}
+
+void MapRegions::ConnectChokes(const Point2D &enemy_start) {
+	size_t count = chokes_.size();
+	choke_distances_.assign(count * count, kInfinity);
+	for (size_t i = 0; i < count; ++i) {
+		choke_distances_[i * count + i] = 0.0f;
+	}
+	for (const auto &region : regions_) { // Chokes of one region are connected across it
+		for (int i : region.chokes) {
+			for (int j : region.chokes) {
+				float distance = Distance2D(chokes_[i].pos, chokes_[j].pos);
+				choke_distances_[i * count + j] = std::min(choke_distances_[i * count + j], distance);
+			}
+		}
+	}
+	for (size_t k = 0; k < count; ++k) { // Floyd-Warshall, a map has at most a few hundred chokes
+		for (size_t i = 0; i < count; ++i) {
+			float through_k = choke_distances_[i * count + k];
+			if (through_k >= kInfinity) {
+				continue;
+			}
+			for (size_t j = 0; j < count; ++j) {
+				choke_distances_[i * count + j] = std::min(choke_distances_[i * count + j], through_k + choke_distances_[k * count + j]);
+			}
+		}
+	}
+
+	int enemy_region = RegionAt(enemy_start);
+	if (enemy_region < 0) {
+		return;
+	}
+	for (int r = 0; r < static_cast<int>(regions_.size()); ++r) {
+		if (r == enemy_region) {
+			continue;
+		}
+		float closest = kInfinity;
+		for (int choke : regions_[r].chokes) {
+			float distance = kInfinity;
+			for (int enemy_choke : regions_[enemy_region].chokes) {
+				distance = std::min(distance, choke_distances_[choke * count + enemy_choke] + Distance2D(chokes_[enemy_choke].pos, enemy_start));
+			}
+			if (distance < closest) {
+				closest = distance;
+				regions_[r].guard_choke = choke;
+			}
+		}
+	}
+}
+
+void MapRegions::LinkExpansions(const std::vector<Point3D> &expansions) {
+	expansion_regions_.assign(expansions.size(), -1);
+	for (size_t i = 0; i < expansions.size(); ++i) {
+		for (int radius = 0; radius <= kExpansionSearch && expansion_regions_[i] < 0; ++radius) { // Rings around the town hall center
+			for (int dy = -radius; dy <= radius && expansion_regions_[i] < 0; ++dy) {
+				for (int dx = -radius; dx <= radius && expansion_regions_[i] < 0; ++dx) {
+					expansion_regions_[i] = RegionAt(Point2D(expansions[i].x + dx, expansions[i].y + dy));
+				}
+			}
+		}
+	}
+}
+
+int MapRegions::RegionAt(const Point2D &point) const {
+	int x = static_cast<int>(point.x);
+	int y = static_cast<int>(point.y);
+	if (point.x < 0.0f || point.y < 0.0f || x >= width_ || y >= height_) {
+		return -1;
+	}
+	return region_of_[y * width_ + x];
+}
+
+const Chokepoint *MapRegions::GuardingChoke(const Point2D &point) const {
+	int region = RegionAt(point);
+	if (region < 0 || regions_[region].guard_choke < 0) {
+		return nullptr;
+	}
+	return &chokes_[regions_[region].guard_choke];
+}
+
+float MapRegions::PathDistance(const Point2D &a, const Point2D &b) const { return PathDistance(a, RegionAt(a), b, RegionAt(b)); }
+
+float MapRegions::PathDistance(const Point2D &a, int region_a, const Point2D &b, int region_b) const {
+	float straight = Distance2D(a, b);
+	if (region_a < 0 || region_b < 0 || region_a == region_b) {
+		return straight;
+	}
+	size_t count = chokes_.size();
+	float shortest = kInfinity;
+	for (int choke_a : regions_[region_a].chokes) {
+		float to_choke = Distance2D(a, chokes_[choke_a].pos);
+		for (int choke_b : regions_[region_b].chokes) {
+			shortest = std::min(shortest, to_choke + choke_distances_[choke_a * count + choke_b] + Distance2D(chokes_[choke_b].pos, b));
+		}
+	}
+	return shortest < kInfinity ? shortest : straight;
+}
@@ -0,0 +1,65 @@
+#ifndef MAP_REGIONS_H
+#define MAP_REGIONS_H
+
+#include "sc2api/sc2_api.h"
+
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace sc2;
+
+struct MapRegion {
+	Point2D center;           // Widest point, farthest from any wall
+	float radius;             // Distance from the center to the closest wall
+	int tiles;
+	std::vector<int> chokes;  // Indices into MapRegions::Chokes
+	int guard_choke = -1;     // Choke on the way toward the enemy start, -1 for the enemy region and islands
+};
+
+struct Chokepoint {
+	Point2D pos;     // Middle of the narrowest line across
+	float width;     // Tiles across
+	int regions[2];
+};
+
+// Regions and chokepoints of the walkable ground, built once per map. A distance transform of the
+// pathing grid runs in parallel over columns and then rows, and a watershed over it grows one
+// region from every wide spot. Two regions stay apart where they only meet through a passage much
+// narrower than both, and that passage is their chokepoint. Lookups after Build are array reads.
+class MapRegions {
+  public:
+	void Build(const GameInfo &game_info, ThreadPool &pool);
+	void LinkExpansions(const std::vector<Point3D> &expansions); // Call again when the expansion list changes
+	bool Built() const { return !regions_.empty(); }
+
+	int RegionAt(const Point2D &point) const; // -1 off walkable ground
+	int ExpansionRegion(size_t expansion) const { return expansion < expansion_regions_.size() ? expansion_regions_[expansion] : -1; }
+	const std::vector<MapRegion> &Regions() const { return regions_; }
+	const std::vector<Chokepoint> &Chokes() const { return chokes_; }
+	const Chokepoint *GuardingChoke(const Point2D &point) const; // Choke of the point's region toward the enemy, null if none
+
+	// Ground distance through chokes, straight within a region. Falls back to the straight line
+	// when either point is off walkable ground or the regions are not connected.
+	float PathDistance(const Point2D &a, const Point2D &b) const;
+	float PathDistance(const Point2D &a, int region_a, const Point2D &b, int region_b) const; // Regions already looked up
+	float BuildMilliseconds() const { return build_milliseconds_; }
+
+  private:
+	void ComputeDistances(const std::vector<uint8_t> &walkable, ThreadPool &pool);
+	void Watershed(const std::vector<uint8_t> &walkable);
+	void ConnectChokes(const Point2D &enemy_start);
+
+	int width_ = 0;
+	int height_ = 0;
+	std::vector<float> distance_;        // To the closest unwalkable tile, per tile
+	std::vector<int16_t> region_of_;     // Per tile, -1 off walkable ground
+	std::vector<MapRegion> regions_;
+	std::vector<Chokepoint> chokes_;
+	std::vector<float> choke_distances_; // Ground distance between every pair of chokes
+	std::vector<int> expansion_regions_;
+	float build_milliseconds_ = 0.0f;
+};
+
+#endif
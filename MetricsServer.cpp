@@ -0,0 +1,163 @@
+#include "MetricsServer.h"
+
+#include "civetweb.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+const uint32_t kWindowLoops = 224; // Steps per second and APM over the last 10 game seconds
+const double kLoopsPerMinute = 22.4 * 60.0;
+
+struct GaugeInfo {
+	const char *name;
+	const char *help;
+};
+
+const GaugeInfo kGauges[] = {
+    {"sc2bot_steps_per_second", "Steps per wall clock second over the last window"},
+    {"sc2bot_apm", "Actions per game minute over the last window"},
+    {"sc2bot_mineral_income", "Minerals collected per game second"},
+    {"sc2bot_vespene_income", "Vespene collected per game second"},
+    {"sc2bot_minerals", "Unspent minerals"},
+    {"sc2bot_vespene", "Unspent vespene"},
+    {"sc2bot_supply_used", "Supply used"},
+    {"sc2bot_supply_cap", "Supply cap"},
+    {"sc2bot_larva", "Larva available"},
+    {"sc2bot_trace_queue", "Decision trace records waiting for the writer thread"},
+    {"sc2bot_analysis_queue", "Analysis tasks submitted and not started"},
+    {"sc2bot_build_order_left", "Opener steps not started yet"},
+};
+static_assert(sizeof(kGauges) / sizeof(kGauges[0]) == static_cast<size_t>(MetricGauge::Count), "Metric gauge names out of sync");
+
+const double kQuantiles[] = {0.5, 0.9, 0.99};
+
+double BucketSeconds(int bucket) { return std::pow(2.0, bucket / 4.0) * 1e-6; } // Upper bound
+
+void Append(std::string &out, const char *format, ...) {
+	char line[256];
+	va_list args;
+	va_start(args, format);
+	int length = std::vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	if (length > 0) {
+		out.append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+	}
+}
+} // namespace
+
+MetricsServer::MetricsServer() : step_nanoseconds_(0), actions_(0) {
+	for (auto &bucket : step_buckets_) {
+		bucket.store(0);
+	}
+	for (auto &gauge : gauges_) {
+		gauge.store(0.0);
+	}
+}
+
+MetricsServer::~MetricsServer() { Stop(); }
+
+bool MetricsServer::Start(int port) {
+	if (context_) {
+		return true;
+	}
+	std::string ports = "127.0.0.1:" + std::to_string(port); // Not reachable from other machines
+	const char *options[] = {"listening_ports", ports.c_str(), "num_threads", "1", nullptr};
+	mg_callbacks callbacks;
+	std::memset(&callbacks, 0, sizeof(callbacks));
+	context_ = mg_start(&callbacks, nullptr, options);
+	if (!context_) {
+		return false;
+	}
+	mg_set_request_handler(context_, "/metrics", HandleMetrics, this);
+	window_start_ = std::chrono::steady_clock::now();
+	return true;
+}
+
+void MetricsServer::Stop() {
+	if (context_) {
+		mg_stop(context_); // Waits for the request in flight
+		context_ = nullptr;
+	}
+}
+
+void MetricsServer::RecordStep(int64_t step_nanoseconds, uint32_t game_loop) {
+	// Single writer, so plain load and store instead of a locked add
+	double micros = step_nanoseconds / 1000.0;
+	int bucket = micros <= 1.0 ? 0 : static_cast<int>(std::ceil(4.0 * std::log2(micros)));
+	bucket = std::min(bucket, kStepBuckets - 1);
+	step_buckets_[bucket].store(step_buckets_[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	step_nanoseconds_.store(step_nanoseconds_.load(std::memory_order_relaxed) + step_nanoseconds, std::memory_order_relaxed);
+	actions_.store(actions_.load(std::memory_order_relaxed) + step_actions_, std::memory_order_relaxed);
+	window_actions_ += step_actions_;
+	step_actions_ = 0;
+	window_steps_++;
+
+	if (game_loop < window_loop_) { // New game
+		window_loop_ = game_loop;
+	}
+	uint32_t loops = game_loop - window_loop_;
+	if (loops < kWindowLoops) {
+		return;
+	}
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(now - window_start_).count();
+	if (seconds > 0.0) {
+		Set(MetricGauge::StepsPerSecond, window_steps_ / seconds);
+	}
+	Set(MetricGauge::Apm, window_actions_ * kLoopsPerMinute / loops);
+	window_loop_ = game_loop;
+	window_steps_ = 0;
+	window_actions_ = 0;
+	window_start_ = now;
+}
+
+int MetricsServer::HandleMetrics(mg_connection *connection, void *server) {
+	std::string body;
+	static_cast<const MetricsServer *>(server)->Render(body);
+	mg_printf(connection,
+	          "HTTP/1.1 200 OK\r\n"
+	          "Content-Type: text/plain; version=0.0.4\r\n"
+	          "Content-Length: %lu\r\n"
+	          "Connection: close\r\n\r\n",
+	          static_cast<unsigned long>(body.size()));
+	mg_write(connection, body.data(), body.size());
+	return 200;
+}
+
+void MetricsServer::Render(std::string &out) const {
+	uint64_t buckets[kStepBuckets];
+	uint64_t steps = 0;
+	for (int i = 0; i < kStepBuckets; ++i) { // Count from the buckets so the quantiles agree with each other
+		buckets[i] = step_buckets_[i].load(std::memory_order_relaxed);
+		steps += buckets[i];
+	}
+
+	Append(out, "# HELP sc2bot_step_seconds OnStep latency, quantiles are bucket upper bounds\n");
+	Append(out, "# TYPE sc2bot_step_seconds summary\n");
+	for (double quantile : kQuantiles) {
+		uint64_t rank = static_cast<uint64_t>(std::ceil(quantile * steps));
+		uint64_t seen = 0;
+		int bucket = 0;
+		for (; bucket < kStepBuckets - 1; ++bucket) {
+			seen += buckets[bucket];
+			if (seen >= rank && seen > 0) {
+				break;
+			}
+		}
+		Append(out, "sc2bot_step_seconds{quantile=\"%g\"} %g\n", quantile, steps > 0 ? BucketSeconds(bucket) : 0.0);
+	}
+	Append(out, "sc2bot_step_seconds_sum %.9f\n", step_nanoseconds_.load(std::memory_order_relaxed) / 1e9);
+	Append(out, "sc2bot_step_seconds_count %llu\n", static_cast<unsigned long long>(steps));
+
+	Append(out, "# HELP sc2bot_actions_total Actions issued\n# TYPE sc2bot_actions_total counter\n");
+	Append(out, "sc2bot_actions_total %llu\n", static_cast<unsigned long long>(actions_.load(std::memory_order_relaxed)));
+
+	for (size_t i = 0; i < static_cast<size_t>(MetricGauge::Count); ++i) {
+		Append(out, "# HELP %s %s\n# TYPE %s gauge\n", kGauges[i].name, kGauges[i].help, kGauges[i].name);
+		Append(out, "%s %g\n", kGauges[i].name, gauges_[i].load(std::memory_order_relaxed));
+	}
+}
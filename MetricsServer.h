@@ -0,0 +1,70 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+struct mg_context;
+struct mg_connection;
+
+// Gauges the bot sets once per step. Append with a name and help line in MetricsServer.cpp.
+enum class MetricGauge : uint8_t {
+	StepsPerSecond,
+	Apm, // Actions per game minute
+	MineralRate,
+	VespeneRate,
+	Minerals,
+	Vespene,
+	SupplyUsed,
+	SupplyCap,
+	Larva,
+	TraceQueue,    // Decision trace records waiting for the writer
+	AnalysisQueue, // Analysis tasks submitted and not started
+	BuildOrderLeft,
+	Count
+};
+
+// Serves the bot's live metrics in the Prometheus text format on a local port. The game thread
+// publishes with relaxed stores to atomics it alone writes, and the civetweb thread only loads
+// them, so a scrape never takes a lock OnStep could wait on. A scrape may mix two steps.
+class MetricsServer {
+  public:
+	MetricsServer();
+	~MetricsServer();
+
+	MetricsServer(const MetricsServer &) = delete;
+	MetricsServer &operator=(const MetricsServer &) = delete;
+
+	bool Start(int port); // Listens on 127.0.0.1 only
+	void Stop();
+	bool IsRunning() const { return context_ != nullptr; }
+
+	// Game thread only
+	void RecordAction() { step_actions_++; }
+	void RecordStep(int64_t step_nanoseconds, uint32_t game_loop); // Also updates steps per second and APM
+	void Set(MetricGauge gauge, double value) { gauges_[static_cast<size_t>(gauge)].store(value, std::memory_order_relaxed); }
+
+  private:
+	static const int kStepBuckets = 80; // Quarter powers of two of a microsecond, the last one is up to a second and over
+
+	static int HandleMetrics(mg_connection *connection, void *server);
+	void Render(std::string &out) const;
+
+	std::atomic<uint64_t> step_buckets_[kStepBuckets];
+	std::atomic<uint64_t> step_nanoseconds_;
+	std::atomic<uint64_t> actions_;
+	std::atomic<double> gauges_[static_cast<size_t>(MetricGauge::Count)];
+
+	// Rate window, game thread only
+	uint32_t step_actions_ = 0;
+	uint32_t window_loop_ = 0;
+	uint32_t window_steps_ = 0;
+	uint32_t window_actions_ = 0;
+	std::chrono::steady_clock::time_point window_start_;
+
+	mg_context *context_ = nullptr;
+};
+
+#endif
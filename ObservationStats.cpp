@@ -0,0 +1,56 @@
+#include "ObservationStats.h"
+
+#include "s2clientprotocol/sc2api.pb.h"
+#include "sc2api/sc2_unit.h"
+
+#include "google/protobuf/arena.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+const size_t kMinArenaBlock = 64 * 1024;
+} // namespace
+
+void ObservationStats::Record(const SC2APIProtocol::Observation &observation, size_t units, size_t list_bytes) {
+	observation.SerializeToString(&encoded_);
+	if (arena_block_.empty()) {
+		arena_block_.resize(std::max(kMinArenaBlock, encoded_.size() * 4));
+	}
+
+	google::protobuf::ArenaOptions options;
+	options.initial_block = arena_block_.data();
+	options.initial_block_size = arena_block_.size();
+	uint64_t used;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	{
+		google::protobuf::Arena arena(options); // Frees only the blocks it added past the initial one
+		SC2APIProtocol::Observation *decoded = google::protobuf::Arena::CreateMessage<SC2APIProtocol::Observation>(&arena);
+		decoded->ParseFromString(encoded_);
+		used = arena.SpaceUsed();
+	}
+	uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	if (used > arena_block_.size()) { // Next step decodes into one block
+		arena_block_.resize(used + used / 4);
+		arena_growths_++;
+	}
+
+	steps_++;
+	bytes_ += encoded_.size();
+	max_bytes_ = std::max<uint64_t>(max_bytes_, encoded_.size());
+	units_ += units;
+	list_bytes_ += list_bytes;
+	decode_nanoseconds_ += nanoseconds;
+	max_decode_nanoseconds_ = std::max(max_decode_nanoseconds_, nanoseconds);
+}
+
+void ObservationStats::Print(std::ostream &out) const {
+	if (steps_ == 0) {
+		return;
+	}
+	double unit_kilobytes = units_ * sizeof(sc2::Unit) / 1024.0; // Fixed part only, orders and buffs are extra
+	out << "Observation: " << bytes_ / 1024.0 / steps_ << " KB/step decoded (max " << max_bytes_ / 1024.0 << " KB), " << units_ / static_cast<double>(steps_)
+	    << " units/step, " << unit_kilobytes / steps_ << " KB/step copied to units, " << list_bytes_ / 1024.0 / steps_ << " KB/step to unit lists" << std::endl;
+	out << "Observation decode: " << decode_nanoseconds_ / 1e6 / steps_ << " ms/step (max " << max_decode_nanoseconds_ / 1e6 << " ms), arena block " << arena_block_.size() / 1024
+	    << " KB, grown " << arena_growths_ << " times" << std::endl;
+}
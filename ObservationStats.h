@@ -0,0 +1,36 @@
+#ifndef OBSERVATION_STATS_H
+#define OBSERVATION_STATS_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace SC2APIProtocol {
+class Observation;
+}
+
+// Measures what each step's observation costs before OnStep runs, for builds configured with
+// BASICSC2BOT_OBSERVATION_STATS. cpp-sc2 decodes the response and converts it to Unit objects
+// out of the bot's reach, so the observation is encoded again and decoded into an arena that
+// starts in a block kept between steps. Once the block fits the largest observation seen, the
+// decode allocates nothing and its time is the parse cost alone.
+class ObservationStats {
+  public:
+	void Record(const SC2APIProtocol::Observation &observation, size_t units, size_t list_bytes);
+	void Print(std::ostream &out) const; // Per step averages and peaks
+
+  private:
+	std::string encoded_;           // Reused, keeps the capacity of the largest observation
+	std::vector<char> arena_block_; // First block of every step's arena
+	uint64_t steps_ = 0;
+	uint64_t bytes_ = 0; // Encoded observation size
+	uint64_t max_bytes_ = 0;
+	uint64_t units_ = 0;      // Converted to Unit objects by cpp-sc2
+	uint64_t list_bytes_ = 0; // Copied into the bot's unit lists, see StepUnits
+	uint64_t decode_nanoseconds_ = 0;
+	uint64_t max_decode_nanoseconds_ = 0;
+	uint64_t arena_growths_ = 0; // Steps whose decode outgrew the reused block
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include "QueenManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const float kInjectEnergy = 25.0f;
+const float kEnergyPerLoop = 0.7875f / 22.4f; // 0.7875 energy per game second, 22.4 loops per second on faster
+const uint32_t kInjectLoops = 650;            // 29 game seconds
+
+bool HasOrder(const Unit *unit, ABILITY_ID ability) {
+	for (const auto &order : unit->orders) {
+		if (order.ability_id == ability) {
+			return true;
+		}
+	}
+	return false;
+}
+} // namespace
+
+void QueenManager::Reset() {
+	hatcheries_.clear();
+	queens_.clear();
+	game_loop_ = 0;
+	bound_loops_ = 0;
+	injected_loops_ = 0;
+}
+
+void QueenManager::AddHatchery(const Unit *hatchery) {
+	if (FindHatchery(hatchery->tag) >= 0) {
+		return;
+	}
+	Hatchery entry;
+	entry.tag = hatchery->tag;
+	entry.pos = hatchery->pos;
+	hatcheries_.push_back(entry);
+	BindFreeQueens();
+}
+
+void QueenManager::AddQueen(const Unit *queen) {
+	for (const auto &existing : queens_) {
+		if (existing.tag == queen->tag) {
+			return;
+		}
+	}
+	Queen entry;
+	entry.tag = queen->tag;
+	entry.pos = queen->pos;
+	queens_.push_back(entry);
+	Bind(queens_.back());
+}
+
+void QueenManager::Remove(Tag tag) {
+	for (size_t i = 0; i < hatcheries_.size(); ++i) {
+		if (hatcheries_[i].tag == tag) { // Its queen moves to another hatchery without one, if any
+			int index = static_cast<int>(i);
+			for (auto &queen : queens_) { // Later hatcheries shift down by one
+				if (queen.hatchery == index) {
+					queen.hatchery = -1;
+				} else if (queen.hatchery > index) {
+					queen.hatchery--;
+				}
+			}
+			hatcheries_.erase(hatcheries_.begin() + i);
+			BindFreeQueens();
+			return;
+		}
+	}
+	for (size_t i = 0; i < queens_.size(); ++i) {
+		if (queens_[i].tag == tag) {
+			if (queens_[i].hatchery >= 0) {
+				hatcheries_[queens_[i].hatchery].queen = NullTag;
+			}
+			queens_.erase(queens_.begin() + i);
+			BindFreeQueens();
+			return;
+		}
+	}
+}
+
+int QueenManager::FindHatchery(Tag tag) const {
+	for (size_t i = 0; i < hatcheries_.size(); ++i) {
+		if (hatcheries_[i].tag == tag) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+void QueenManager::Bind(Queen &queen) {
+	int closest = -1;
+	float closest_distance = std::numeric_limits<float>::max();
+	for (size_t i = 0; i < hatcheries_.size(); ++i) {
+		float distance = DistanceSquared2D(hatcheries_[i].pos, queen.pos);
+		if (hatcheries_[i].queen == NullTag && distance < closest_distance) {
+			closest_distance = distance;
+			closest = static_cast<int>(i);
+		}
+	}
+	if (closest >= 0) {
+		hatcheries_[closest].queen = queen.tag;
+		queen.hatchery = closest;
+	}
+}
+
+void QueenManager::BindFreeQueens() {
+	for (auto &queen : queens_) {
+		if (queen.hatchery < 0) {
+			Bind(queen);
+		}
+	}
+}
+
+void QueenManager::Update(const ObservationInterface *observation, std::vector<InjectOrder> &injects) {
+	uint32_t game_loop = observation->GetGameLoop();
+	uint32_t elapsed = game_loop - game_loop_;
+	game_loop_ = game_loop;
+
+	for (auto &hatchery : hatcheries_) {
+		const Unit *unit = observation->GetUnit(hatchery.tag);
+		if (!unit) {
+			continue;
+		}
+		hatchery.training_queen = HasOrder(unit, ABILITY_ID::TRAIN_QUEEN);
+		bool injected = std::find(unit->buffs.begin(), unit->buffs.end(), BUFF_ID::QUEENSPAWNLARVATIMER) != unit->buffs.end();
+		if (injected && !hatchery.injected) { // The inject landed, the timer runs from now rather than from the order
+			hatchery.inject_end_loop = std::max(hatchery.inject_end_loop, game_loop + kInjectLoops);
+		}
+		hatchery.injected = injected;
+		if (hatchery.queen != NullTag) {
+			bound_loops_ += elapsed;
+			injected_loops_ += injected ? elapsed : 0;
+		}
+	}
+
+	for (auto &queen : queens_) {
+		if (queen.hatchery >= 0 && queen.ready_loop > game_loop) { // Energy only comes from regeneration, nothing to do before the predicted loop
+			continue;
+		}
+		const Unit *unit = observation->GetUnit(queen.tag);
+		if (!unit) {
+			continue;
+		}
+		queen.pos = unit->pos; // Unbound queens bind to the hatchery closest to here
+		if (queen.hatchery < 0) {
+			continue;
+		}
+		Hatchery *hatchery = &hatcheries_[queen.hatchery];
+
+		bool inject_ordered = HasOrder(unit, ABILITY_ID::EFFECT_INJECTLARVA);
+		if (!hatchery->injected && !inject_ordered && hatchery->inject_end_loop > game_loop) { // The order never landed
+			hatchery->inject_end_loop = game_loop;
+		}
+		queen.ready_loop = unit->energy >= kInjectEnergy ? game_loop : game_loop + static_cast<uint32_t>(std::ceil((kInjectEnergy - unit->energy) / kEnergyPerLoop));
+
+		// Inject the step the energy is there, queueing at most one inject behind the running one
+		if (queen.ready_loop <= game_loop && !inject_ordered && hatchery->inject_end_loop < game_loop + kInjectLoops) {
+			const Unit *hatchery_unit = observation->GetUnit(hatchery->tag);
+			if (hatchery_unit) {
+				injects.push_back({unit, hatchery_unit, queen.hatchery});
+			}
+		}
+	}
+}
+
+void QueenManager::OnInjectIssued(const InjectOrder &inject, uint32_t game_loop) { // Same step as Update, the slot is still valid
+	Hatchery &entry = hatcheries_[inject.slot];
+	entry.inject_end_loop = std::max(entry.inject_end_loop, game_loop) + kInjectLoops;
+}
+
+const Unit *QueenManager::HatcheryWithoutQueen(const ObservationInterface *observation) const {
+	for (const auto &hatchery : hatcheries_) {
+		if (hatchery.queen == NullTag && !hatchery.training_queen) {
+			const Unit *unit = observation->GetUnit(hatchery.tag);
+			if (unit) {
+				return unit;
+			}
+		}
+	}
+	return nullptr;
+}
+
+bool QueenManager::IsBound(Tag queen) const {
+	for (const auto &entry : queens_) {
+		if (entry.tag == queen) {
+			return entry.hatchery >= 0;
+		}
+	}
+	return false;
+}
+
+float QueenManager::InjectUptime() const { return bound_loops_ > 0 ? static_cast<float>(injected_loops_) / bound_loops_ : 0.0f; }
@@ -0,0 +1,63 @@
+#ifndef QUEEN_MANAGER_H
+#define QUEEN_MANAGER_H
+
+#include "sc2api/sc2_api.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace sc2;
+
+struct InjectOrder {
+	const Unit *queen;
+	const Unit *hatchery;
+	int slot; // The hatchery's entry in the manager, so OnInjectIssued needs no lookup
+};
+
+// Binds each queen to one finished hatchery and predicts when the queen has inject energy and when
+// the hatchery's inject runs out. Units are registered from the unit events and a queen keeps the
+// index of its hatchery, so a step costs one GetUnit per hatchery and per queen that can inject,
+// and never scans a list. Queens still regenerating are skipped until their predicted ready loop.
+class QueenManager {
+  public:
+	void Reset();
+	void AddHatchery(const Unit *hatchery); // Finished hatcheries only, lairs and hives keep the tag
+	void AddQueen(const Unit *queen);       // Binds the queen to the closest hatchery without one
+	void Remove(Tag tag);                   // Queen or hatchery died, frees its partner
+
+	// Refreshes energy and inject timers and fills injects with the queens that can inject this step
+	void Update(const ObservationInterface *observation, std::vector<InjectOrder> &injects);
+	void OnInjectIssued(const InjectOrder &inject, uint32_t game_loop);
+
+	const Unit *HatcheryWithoutQueen(const ObservationInterface *observation) const; // Not training one either
+	bool IsBound(Tag queen) const;
+	float InjectUptime() const; // Share of hatchery time spent injected, over bound hatcheries
+
+  private:
+	struct Hatchery {
+		Tag tag;
+		Point2D pos;
+		Tag queen = NullTag;
+		uint32_t inject_end_loop = 0; // Predicted expiry of the injects queued on it
+		bool injected = false;        // Had the inject buff last step
+		bool training_queen = false;
+	};
+	struct Queen {
+		Tag tag;
+		Point2D pos;
+		int hatchery = -1;       // Index into hatcheries_, -1 when unbound
+		uint32_t ready_loop = 0; // Predicted loop the queen reaches inject energy, spending energy only makes it later
+	};
+
+	int FindHatchery(Tag tag) const; // -1 when not registered
+	void Bind(Queen &queen);
+	void BindFreeQueens();
+
+	std::vector<Hatchery> hatcheries_;
+	std::vector<Queen> queens_;
+	uint32_t game_loop_ = 0;
+	uint64_t bound_loops_ = 0;    // Loops summed over hatcheries that had a queen
+	uint64_t injected_loops_ = 0; // Of those, loops with an inject running
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "ScoutPlanner.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const uint32_t kFreshLoops = 448;       // Sites seen in the last 20 seconds are not worth a trip
+const uint32_t kMaxAgeLoops = 4032;     // Three minutes out of sight is as stale as it gets
+const uint32_t kDangerLoops = 2688;     // Two minutes off limits after a scout was hit there
+const float kDangerRadius = 10.0f;      // Routes this close to a danger point stay in range of what hit the scout
+const uint32_t kRetreatLoops = 448;     // Time to get out of range before taking a new site
+const float kTravelBiasSeconds = 10.0f; // Keeps a close site from winning on distance alone
+const float kLoopsPerSecond = 22.4f;
+
+float Speed(UNIT_TYPEID type) { return type == UNIT_TYPEID::ZERG_ZERGLING ? 4.13f : 0.902f; } // Without speed upgrades
+} // namespace
+
+void ScoutPlanner::Reset() {
+	sites_.clear();
+	scouts_.clear();
+	dangers_.clear();
+}
+
+void ScoutPlanner::AddSite(const Point2D &pos, float weight, bool ground_only) { sites_.push_back({pos, weight, ground_only, NullTag}); }
+
+void ScoutPlanner::Add(const Unit *unit) { scouts_.push_back({unit->tag, unit->unit_type, -1, unit->pos, unit->health, 0}); }
+
+void ScoutPlanner::Remove(const Unit *unit, uint32_t game_loop) {
+	for (size_t i = 0; i < scouts_.size(); ++i) {
+		if (scouts_[i].tag == unit->tag) {
+			Release(scouts_[i]);
+			AddDanger(unit->pos, game_loop);
+			scouts_[i] = scouts_.back();
+			scouts_.pop_back();
+			return;
+		}
+	}
+}
+
+size_t ScoutPlanner::Count(UNIT_TYPEID type) const {
+	return std::count_if(scouts_.begin(), scouts_.end(), [type](const Scout &scout) { return scout.type == type; });
+}
+
+void ScoutPlanner::Plan(const ObservationInterface *observation, const VisibilityGrid &visibility, uint32_t game_loop, const Point2D &home, std::vector<ScoutOrder> &orders) {
+	orders.clear();
+	dangers_.erase(std::remove_if(dangers_.begin(), dangers_.end(), [game_loop](const DangerPoint &danger) { return danger.until <= game_loop; }), dangers_.end());
+	for (size_t i = 0; i < scouts_.size();) {
+		Scout &scout = scouts_[i];
+		const Unit *unit = observation->GetUnit(scout.tag);
+		if (!unit || !unit->is_alive) { // Died without an event reaching us
+			Release(scout);
+			AddDanger(scout.pos, game_loop);
+			scout = scouts_.back();
+			scouts_.pop_back();
+			continue;
+		}
+		++i;
+
+		bool hit = unit->health < scout.health;
+		scout.health = unit->health; // Zerg regenerate, so compare with the last plan only
+		scout.pos = unit->pos;
+		if (hit) {
+			Release(scout);
+			AddDanger(unit->pos, game_loop);
+			scout.retreat_until = game_loop + kRetreatLoops;
+			orders.push_back({unit, home, true});
+			continue;
+		}
+		if (game_loop < scout.retreat_until) {
+			continue;
+		}
+		if (scout.site >= 0) {
+			const ScoutSite &site = sites_[scout.site];
+			if (!visibility.IsVisible(site.pos) && !IsRouteDangerous(unit->pos, site.pos)) { // Still on its way
+				continue;
+			}
+			Release(scout);
+		}
+
+		int site = PickSite(unit, unit->is_flying, visibility, game_loop);
+		if (site >= 0) {
+			scout.site = site;
+			sites_[site].scout = scout.tag;
+			orders.push_back({unit, sites_[site].pos, false});
+		}
+	}
+}
+
+int ScoutPlanner::PickSite(const Unit *unit, bool flying, const VisibilityGrid &visibility, uint32_t game_loop) const {
+	int best = -1;
+	float best_score = 0.0f;
+	float speed = Speed(unit->unit_type);
+	for (size_t i = 0; i < sites_.size(); ++i) {
+		const ScoutSite &site = sites_[i];
+		if (site.scout != NullTag || (flying && site.ground_only)) {
+			continue;
+		}
+		uint32_t age = visibility.Age(site.pos, game_loop);
+		if (age < kFreshLoops || IsRouteDangerous(unit->pos, site.pos)) {
+			continue;
+		}
+		float travel_seconds = Distance2D(unit->pos, site.pos) / speed;
+		float score = site.weight * std::min(age, kMaxAgeLoops) / kLoopsPerSecond / (travel_seconds + kTravelBiasSeconds);
+		if (score > best_score) {
+			best_score = score;
+			best = static_cast<int>(i);
+		}
+	}
+	return best;
+}
+
+bool ScoutPlanner::IsRouteDangerous(const Point2D &from, const Point2D &to) const {
+	Point2D route = to - from;
+	float length_squared = route.x * route.x + route.y * route.y;
+	for (const auto &danger : dangers_) {
+		Point2D offset = danger.pos - from;
+		float t = length_squared > 0.0f ? std::max(0.0f, std::min(1.0f, (offset.x * route.x + offset.y * route.y) / length_squared)) : 0.0f;
+		if (DistanceSquared2D(danger.pos, from + route * t) < kDangerRadius * kDangerRadius) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void ScoutPlanner::Release(Scout &scout) {
+	if (scout.site < 0) {
+		return;
+	}
+	sites_[scout.site].scout = NullTag;
+	scout.site = -1;
+}
+
+void ScoutPlanner::AddDanger(const Point2D &pos, uint32_t game_loop) { dangers_.push_back({pos, game_loop + kDangerLoops}); }
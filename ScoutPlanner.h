@@ -0,0 +1,69 @@
+#ifndef SCOUT_PLANNER_H
+#define SCOUT_PLANNER_H
+
+#include "sc2api/sc2_api.h"
+
+#include "VisibilityGrid.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace sc2;
+
+struct ScoutSite {
+	Point2D pos;
+	float weight;     // How much knowing this spot is worth
+	bool ground_only; // Too well defended for an overlord to reach
+	Tag scout;        // Scout on its way, NullTag when free
+};
+
+struct ScoutOrder {
+	const Unit *unit;
+	Point2D target;
+	bool retreat; // Took damage, heading home
+};
+
+// Sends overlords and zerglings to the sites we have not seen for the longest. A site is worth
+// its weight times how long it has been out of sight, per second of travel to get there. Each
+// site takes one scout, and a scout moves on as soon as its site is in sight. A scout that takes
+// damage turns home and leaves a danger point where it was hit. For a while no scout is sent to a
+// site whose straight route passes near one, so we do not feed overlords to the same marines.
+class ScoutPlanner {
+  public:
+	void Reset();
+	void AddSite(const Point2D &pos, float weight, bool ground_only);
+	const std::vector<ScoutSite> &Sites() const { return sites_; }
+
+	void Add(const Unit *unit);                        // Unit becomes a scout, picked a site on the next Plan
+	void Remove(const Unit *unit, uint32_t game_loop); // Died, where it died turns dangerous
+	size_t Count(UNIT_TYPEID type) const;
+
+	// Fills orders for the scouts that need a new destination or have to retreat to home
+	void Plan(const ObservationInterface *observation, const VisibilityGrid &visibility, uint32_t game_loop, const Point2D &home, std::vector<ScoutOrder> &orders);
+
+  private:
+	struct Scout {
+		Tag tag;
+		UNIT_TYPEID type;
+		int site;               // -1 without a site
+		Point2D pos;            // At the last plan, where it died when no event reached us
+		float health;           // At the last plan, a drop means it is under fire
+		uint32_t retreat_until; // Heading home until this loop
+	};
+
+	struct DangerPoint {
+		Point2D pos;    // Where a scout was hit or died
+		uint32_t until; // Forgotten after this loop
+	};
+
+	int PickSite(const Unit *unit, bool flying, const VisibilityGrid &visibility, uint32_t game_loop) const; // -1 when nothing is worth the trip
+	bool IsRouteDangerous(const Point2D &from, const Point2D &to) const; // The straight line passes near an active danger point
+	void Release(Scout &scout);
+	void AddDanger(const Point2D &pos, uint32_t game_loop);
+
+	std::vector<ScoutSite> sites_;
+	std::vector<Scout> scouts_;
+	std::vector<DangerPoint> dangers_; // Active ones only, Plan drops the expired
+};
+
+#endif
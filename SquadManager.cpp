@@ -0,0 +1,101 @@
+#include "SquadManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const size_t kDefenseSquadSize = 4;  // Ground units kept home before the main squad gets any
+const float kRetargetDistance = 3.0f; // Targets closer than this to the last one only order idle members
+const float kArrivedDistance = 2.0f;  // Idle members this close to the target are there, ordering them again does nothing
+
+Squad &SquadOf(Squad *squads, SquadRole role) { return squads[static_cast<size_t>(role)]; }
+
+float Strength(const Unit *unit) { return unit->health + unit->shield; }
+} // namespace
+
+void SquadManager::Reset() {
+	for (auto &squad : squads_) {
+		squad = Squad();
+	}
+}
+
+SquadRole SquadManager::Add(const Unit *unit) {
+	SquadRole role = SquadRole::Main;
+	if (unit->unit_type == UNIT_TYPEID::ZERG_MUTALISK) {
+		role = SquadRole::Harass;
+	} else if (SquadOf(squads_, SquadRole::Defense).members.size() < kDefenseSquadSize) { // Refilled first when defenders die
+		role = SquadRole::Defense;
+	}
+
+	Squad &squad = SquadOf(squads_, role);
+	SquadMember member = {unit->tag, unit->pos, Strength(unit), unit->orders.empty()};
+	squad.members.push_back(member);
+	squad.position_sum += member.pos;
+	squad.strength += member.strength;
+	Recenter(squad);
+	return role;
+}
+
+void SquadManager::Remove(Tag tag, SquadRole role) {
+	Squad &squad = SquadOf(squads_, role);
+	for (size_t i = 0; i < squad.members.size(); ++i) {
+		if (squad.members[i].tag == tag) {
+			squad.position_sum -= squad.members[i].pos;
+			squad.strength -= squad.members[i].strength;
+			squad.members[i] = squad.members.back(); // Order inside a squad does not matter
+			squad.members.pop_back();
+			Recenter(squad);
+			return;
+		}
+	}
+}
+
+bool SquadManager::Refresh(Squad &squad, size_t index, const Unit *unit) {
+	SquadMember &member = squad.members[index];
+	if (!unit || !unit->is_alive) { // Died without an event reaching us
+		squad.position_sum -= member.pos;
+		squad.strength -= member.strength;
+		member = squad.members.back();
+		squad.members.pop_back();
+		return false;
+	}
+	Point2D pos = unit->pos;
+	float strength = Strength(unit);
+	squad.position_sum += pos - member.pos;
+	squad.strength += strength - member.strength;
+	member.pos = pos;
+	member.strength = strength;
+	member.idle = unit->orders.empty();
+	return true;
+}
+
+void SquadManager::Recenter(Squad &squad) {
+	if (squad.members.empty()) { // Drop the rounding the running sums picked up
+		squad.position_sum = Point2D(0.0f, 0.0f);
+		squad.strength = 0.0f;
+		squad.radius = 0.0f;
+		return;
+	}
+	squad.center = squad.position_sum / static_cast<float>(squad.members.size());
+	float radius_squared = 0.0f;
+	for (const auto &member : squad.members) { // Cached positions, no API calls
+		radius_squared = std::max(radius_squared, DistanceSquared2D(member.pos, squad.center));
+	}
+	squad.radius = std::sqrt(radius_squared);
+}
+
+bool SquadManager::Retarget(Squad &squad, const Point2D &target) {
+	bool moved = !squad.has_target || DistanceSquared2D(squad.target, target) > kRetargetDistance * kRetargetDistance;
+	if (moved) {
+		squad.target = target;
+		squad.has_target = true;
+	}
+	return moved;
+}
+
+bool SquadManager::NeedsOrder(const Squad &squad, const SquadMember &member, bool moved) {
+	if (moved) {
+		return true;
+	}
+	return member.idle && DistanceSquared2D(member.pos, squad.target) > kArrivedDistance * kArrivedDistance;
+}
@@ -0,0 +1,92 @@
+#ifndef SQUAD_MANAGER_H
+#define SQUAD_MANAGER_H
+
+#include "sc2api/sc2_api.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace sc2;
+
+enum class SquadRole : uint8_t {
+	Main,    // Attacks once big enough, gathers at the rally point until then
+	Harass,  // Mutalisks, raid enemy bases on their own
+	Defense, // Stays home and answers threats while the main squad is away
+	Count
+};
+
+struct SquadMember {
+	Tag tag;
+	Point2D pos;    // Position at the last update
+	float strength; // Health and shields at the last update
+	bool idle;
+};
+
+struct Squad {
+	std::vector<SquadMember> members;
+	Point2D position_sum; // Sum of member positions, moved by each member's step delta
+	Point2D center;
+	float radius = 0.0f;   // Distance from the center to the farthest member
+	float strength = 0.0f; // Health and shields of all members
+	Point2D target;
+	bool has_target = false;
+};
+
+// Persistent groups of combat units that are ordered as one. Membership changes only when a unit
+// joins or leaves, and the center and strength are kept as running sums, so a step costs one
+// unit lookup per member and the army decisions are made once per squad. Update and Order take
+// the lookup as a function of the tag, so they run on synthetic games as well as on the API.
+class SquadManager {
+  public:
+	void Reset();
+	SquadRole Add(const Unit *unit); // Picks the squad by unit type and how full the defense squad is
+	void Remove(Tag tag, SquadRole role);
+	void Update(const ObservationInterface *observation) { Update([observation](Tag tag) { return observation->GetUnit(tag); }); }
+	template <class Lookup> void Update(Lookup lookup); // Refreshes positions and strength, drops members that are gone. Lookup returns null for those
+
+	const Squad &Get(SquadRole role) const { return squads_[static_cast<size_t>(role)]; }
+
+	// Points the squad at target and fills units with the members to order: every member when the
+	// target moved, otherwise only the idle ones that have not reached it yet
+	void Order(SquadRole role, const Point2D &target, const ObservationInterface *observation, Units &units) {
+		Order(role, target, [observation](Tag tag) { return observation->GetUnit(tag); }, units);
+	}
+	template <class Lookup> void Order(SquadRole role, const Point2D &target, Lookup lookup, Units &units);
+
+  private:
+	bool Refresh(Squad &squad, size_t index, const Unit *unit); // False when the member was dropped, the last one took its index
+	bool Retarget(Squad &squad, const Point2D &target);          // True when the target moved and every member needs the order
+	static bool NeedsOrder(const Squad &squad, const SquadMember &member, bool moved);
+	void Recenter(Squad &squad);
+
+	Squad squads_[static_cast<size_t>(SquadRole::Count)];
+};
+
+template <class Lookup> void SquadManager::Update(Lookup lookup) {
+	for (auto &squad : squads_) {
+		for (size_t i = 0; i < squad.members.size();) {
+			if (Refresh(squad, i, lookup(squad.members[i].tag))) {
+				++i;
+			}
+		}
+		Recenter(squad);
+	}
+}
+
+template <class Lookup> void SquadManager::Order(SquadRole role, const Point2D &target, Lookup lookup, Units &units) {
+	Squad &squad = squads_[static_cast<size_t>(role)];
+	units.clear();
+	bool moved = Retarget(squad, target);
+	for (auto &member : squad.members) {
+		if (!NeedsOrder(squad, member, moved)) {
+			continue;
+		}
+		const Unit *unit = lookup(member.tag);
+		if (unit) {
+			units.push_back(unit);
+			member.idle = false; // Ordered, a second Order this step leaves it alone
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,243 @@
+#include "StepAnalysis.h"
+
+#include "UnitQueries.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+const float kThreatRadius = 15.0f;          // Enemies this close to a base count as a threat
+const float kMaxPlacementRadius = 10.0f;    // Same search as TryBuildStructure used to do inline
+const float kPlacementStep = 1.0f;
+const float kMinStructureSpacing = 3.0f;
+
+const SnapshotUnit *Nearest(const std::vector<SnapshotUnit> &units, const Point2D &point) { // Ties go to the lower tag so results never depend on list order
+	const SnapshotUnit *nearest = nullptr;
+	float closest_distance = std::numeric_limits<float>::max();
+	for (const auto &unit : units) {
+		float distance = DistanceSquared2D(unit.pos, point);
+		if (distance < closest_distance || (distance == closest_distance && nearest && unit.tag < nearest->tag)) {
+			closest_distance = distance;
+			nearest = &unit;
+		}
+	}
+	return nearest;
+}
+
+template <class Fn> void Timed(StepAnalysis &analysis, int task, Fn fn) { // Each task writes only its own slots
+	auto start = std::chrono::steady_clock::now();
+	fn();
+	auto end = std::chrono::steady_clock::now();
+	analysis.task_nanoseconds[task] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	analysis.task_end_nanoseconds[task] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - analysis.submitted).count();
+}
+} // namespace
+
+void StepSnapshot::Clear() {
+	own_units.clear();
+	bases.clear();
+	drones.clear();
+	combat_units.clear();
+	enemy_units.clear();
+	mineral_fields.clear();
+}
+
+void BuildStepSnapshot(const Units &units, uint32_t game_loop, const Point2D &start_location, StepSnapshot &snapshot) {
+	snapshot.game_loop = game_loop;
+	snapshot.start_location = start_location;
+	snapshot.Clear();
+
+	for (const auto &unit : units) {
+		SnapshotUnit copy = {unit->tag, unit->unit_type.ToType(), unit->pos, unit->build_progress, unit->health, unit->shield, unit->assigned_harvesters, unit->ideal_harvesters,
+		                     !unit->orders.empty()};
+		switch (unit->alliance) {
+		case Unit::Alliance::Self:
+			snapshot.own_units.push_back(copy);
+			if (IsTownHall(copy.unit_type)) {
+				snapshot.bases.push_back(copy);
+			} else if (copy.unit_type == UNIT_TYPEID::ZERG_DRONE) {
+				snapshot.drones.push_back(copy);
+			} else if (IsCombatUnitType(copy.unit_type)) {
+				snapshot.combat_units.push_back(copy);
+			}
+			break;
+		case Unit::Alliance::Enemy:
+			snapshot.enemy_units.push_back(copy);
+			break;
+		case Unit::Alliance::Neutral:
+			if (IsMineralField(copy.unit_type) && unit->mineral_contents > 0) {
+				snapshot.mineral_fields.push_back(copy);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+int64_t StepAnalysis::TotalNanoseconds() const {
+	int64_t total = 0;
+	for (int64_t nanoseconds : task_nanoseconds) {
+		total += nanoseconds;
+	}
+	return total;
+}
+
+int64_t StepAnalysis::WallNanoseconds() const {
+	int64_t wall = 0;
+	for (int64_t nanoseconds : task_end_nanoseconds) {
+		wall = std::max(wall, nanoseconds);
+	}
+	return wall;
+}
+
+void AnalyzeSaturation(const StepSnapshot &snapshot, SaturationAnalysis &result) {
+	result.undersaturated_bases.clear();
+	result.oversaturated_bases.clear();
+	for (const auto &base : snapshot.bases) { // Skip incomplete or mined-out bases
+		if (base.build_progress < 1.0f || base.ideal_harvesters == 0) {
+			continue;
+		}
+
+		int workers_needed = base.ideal_harvesters - base.assigned_harvesters;
+		if (workers_needed > 0) {
+			const SnapshotUnit *mineral = Nearest(snapshot.mineral_fields, base.pos);
+			result.undersaturated_bases.push_back({base.tag, base.pos, mineral ? mineral->tag : NullTag, -workers_needed});
+		} else if (workers_needed < 0) {
+			result.oversaturated_bases.push_back({base.tag, base.pos, NullTag, -workers_needed});
+		}
+	}
+}
+
+void AnalyzeTarget(const StepSnapshot &snapshot, TargetAnalysis &result) {
+	result = TargetAnalysis();
+	if (snapshot.combat_units.empty()) {
+		return;
+	}
+
+	Point2D center(0.0f, 0.0f);
+	for (const auto &unit : snapshot.combat_units) {
+		center += unit.pos;
+	}
+	center /= static_cast<float>(snapshot.combat_units.size());
+	result.army_center = center;
+
+	const SnapshotUnit *target = Nearest(snapshot.enemy_units, center);
+	if (target) {
+		result.has_target = true;
+		result.target = target->pos;
+	}
+}
+
+void AnalyzeThreat(const StepSnapshot &snapshot, ThreatAnalysis &result) {
+	result = ThreatAnalysis();
+	for (const auto &base : snapshot.bases) {
+		Point2D center(0.0f, 0.0f);
+		float strength = 0.0f;
+		int count = 0;
+		for (const auto &enemy : snapshot.enemy_units) {
+			if (DistanceSquared2D(enemy.pos, base.pos) < kThreatRadius * kThreatRadius) {
+				center += enemy.pos;
+				strength += enemy.health + enemy.shield;
+				count++;
+			}
+		}
+		if (count > 0 && strength > result.strength) {
+			result.threatened = true;
+			result.position = center / static_cast<float>(count);
+			result.strength = strength;
+		}
+	}
+}
+
+void AnalyzePlacement(const StepSnapshot &snapshot, PlacementAnalysis &result) {
+	result.candidates.clear();
+
+	const SnapshotUnit *base = nullptr;
+	for (const auto &b : snapshot.bases) { // Find complete base
+		if (b.build_progress == 1.0f) {
+			base = &b;
+			break;
+		}
+	}
+	if (!base) {
+		return;
+	}
+
+	// Rings of growing radius, each position is tested once in the order the old inline search used
+	Point2D base_position = base->pos;
+	for (float radius = 2.0f; radius <= kMaxPlacementRadius; radius += kPlacementStep) {
+		for (float x_offset = -radius; x_offset <= radius; x_offset += kPlacementStep) {
+			for (float y_offset = -radius; y_offset <= radius; y_offset += kPlacementStep) {
+				float offset = std::sqrt(x_offset * x_offset + y_offset * y_offset);
+				if (offset > radius || (radius > 2.0f && offset <= radius - kPlacementStep)) { // Outside this ring or already tested
+					continue;
+				}
+				Point2D test_position = Point2D(base_position.x + x_offset, base_position.y + y_offset);
+				bool is_too_close = false;
+				for (const auto &existing_structure : snapshot.own_units) {
+					if (DistanceSquared2D(test_position, existing_structure.pos) < kMinStructureSpacing * kMinStructureSpacing) {
+						is_too_close = true;
+						break;
+					}
+				}
+				if (!is_too_close) {
+					result.candidates.push_back(test_position);
+				}
+			}
+		}
+	}
+}
+
+void PlanWorkerBalance(const StepSnapshot &snapshot, const std::vector<BaseSaturation> &oversaturated, const std::vector<BaseSaturation> &undersaturated, const UnitRegistry &units,
+                       std::vector<WorkerTransfer> &transfers) {
+	if (undersaturated.empty()) {
+		return;
+	}
+	for (const auto &base : oversaturated) {
+		int extra_workers = base.surplus;
+		for (const auto &worker : snapshot.drones) {
+			if (extra_workers <= 0) {
+				break;
+			}
+			if (!worker.has_orders || DistanceSquared2D(worker.pos, base.pos) >= 100.0f) { // Only busy drones at this base
+				continue;
+			}
+			UnitRole role = units.Role(worker.tag);
+			if (role == UnitRole::Gas || role == UnitRole::Builder) { // Claimed by another job
+				continue;
+			}
+
+			size_t target_index = 0;
+			float min_distance = std::numeric_limits<float>::max();
+			for (size_t i = 0; i < undersaturated.size(); ++i) {
+				float distance = DistanceSquared2D(worker.pos, undersaturated[i].pos);
+				if (distance < min_distance) {
+					min_distance = distance;
+					target_index = i;
+				}
+			}
+			if (undersaturated[target_index].nearest_mineral != NullTag) {
+				transfers.push_back({worker.tag, undersaturated[target_index].nearest_mineral});
+				extra_workers--;
+			}
+		}
+	}
+}
+
+void SubmitStepAnalysis(ThreadPool &pool, const StepSnapshot &snapshot, StepAnalysis &analysis) {
+	// Each task writes only its own result, so scheduling order cannot change the outcome
+	analysis.game_loop = snapshot.game_loop;
+	analysis.submitted = std::chrono::steady_clock::now();
+	pool.Submit([&snapshot, &analysis]() { Timed(analysis, 0, [&]() { AnalyzeSaturation(snapshot, analysis.saturation); }); });
+	pool.Submit([&snapshot, &analysis]() { Timed(analysis, 1, [&]() { AnalyzeTarget(snapshot, analysis.target); }); });
+	pool.Submit([&snapshot, &analysis]() { Timed(analysis, 2, [&]() { AnalyzeThreat(snapshot, analysis.threat); }); });
+	pool.Submit([&snapshot, &analysis]() { Timed(analysis, 3, [&]() { AnalyzePlacement(snapshot, analysis.placement); }); });
+}
+
+void RunStepAnalysis(ThreadPool &pool, const StepSnapshot &snapshot, StepAnalysis &analysis) {
+	SubmitStepAnalysis(pool, snapshot, analysis);
+	pool.Wait();
+}
@@ -0,0 +1,112 @@
+#ifndef STEP_ANALYSIS_H
+#define STEP_ANALYSIS_H
+
+#include "sc2api/sc2_api.h"
+
+#include "ThreadPool.h"
+#include "UnitRegistry.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using namespace sc2;
+
+// Value copy of the unit fields the analyses read. The API updates Unit objects in place when the
+// next observation arrives, so analyses that outlive a step must not hold Unit pointers.
+struct SnapshotUnit {
+	Tag tag;
+	UNIT_TYPEID unit_type;
+	Point2D pos;
+	float build_progress;
+	float health;
+	float shield;
+	int assigned_harvesters;
+	int ideal_harvesters;
+	bool has_orders;
+};
+
+// Read-only view of one game step, built once on the game thread. Analysis tasks only read this
+// and never call the API, so they can run on any thread and always give the same result for the
+// same snapshot.
+struct StepSnapshot {
+	uint32_t game_loop = 0;
+	Point2D start_location;
+	std::vector<SnapshotUnit> own_units;
+	std::vector<SnapshotUnit> bases; // Hatcheries, lairs and hives, finished or not
+	std::vector<SnapshotUnit> drones;
+	std::vector<SnapshotUnit> combat_units;
+	std::vector<SnapshotUnit> enemy_units;
+	std::vector<SnapshotUnit> mineral_fields; // With minerals left
+
+	void Clear(); // Keeps the capacity between steps
+};
+
+struct BaseSaturation {
+	Tag base;
+	Point2D pos;
+	Tag nearest_mineral; // Closest mineral field, NullTag when there is none
+	int surplus;         // Assigned minus ideal harvesters
+};
+
+struct SaturationAnalysis {
+	std::vector<BaseSaturation> undersaturated_bases;
+	std::vector<BaseSaturation> oversaturated_bases;
+};
+
+struct TargetAnalysis {
+	bool has_target = false;
+	Point2D target;      // Enemy closest to the army
+	Point2D army_center; // Average position of combat units
+};
+
+struct ThreatAnalysis {
+	bool threatened = false;
+	Point2D position;      // Center of the strongest enemy group near one of our bases
+	float strength = 0.0f; // Health and shields of that group
+};
+
+struct PlacementAnalysis {
+	std::vector<Point2D> candidates; // Spaced positions around our first finished base, in search order
+};
+
+struct StepAnalysis {
+	uint32_t game_loop = 0; // Loop of the snapshot the results were computed from
+	SaturationAnalysis saturation;
+	TargetAnalysis target;
+	ThreatAnalysis threat;
+	PlacementAnalysis placement;
+	int64_t task_nanoseconds[4] = {};     // Time spent in each task
+	int64_t task_end_nanoseconds[4] = {}; // From the submit until each task finished, for the pipelining report
+	std::chrono::steady_clock::time_point submitted;
+
+	int64_t TotalNanoseconds() const; // Thread time, tasks on different workers overlap
+	int64_t WallNanoseconds() const;  // From the submit until the last task finished, what a serial step waits for
+};
+
+struct WorkerTransfer {
+	Tag drone;
+	Tag mineral;
+};
+
+// Copies the units into the snapshot lists, reusing their capacity
+void BuildStepSnapshot(const Units &units, uint32_t game_loop, const Point2D &start_location, StepSnapshot &snapshot);
+
+void AnalyzeSaturation(const StepSnapshot &snapshot, SaturationAnalysis &result);
+void AnalyzeTarget(const StepSnapshot &snapshot, TargetAnalysis &result);
+void AnalyzeThreat(const StepSnapshot &snapshot, ThreatAnalysis &result);
+void AnalyzePlacement(const StepSnapshot &snapshot, PlacementAnalysis &result);
+
+// Commit phase half of worker balancing, on the game thread. Moves the surplus of busy drones near
+// each oversaturated base to the closest undersaturated base, skipping drones the registry has
+// on gas or building.
+void PlanWorkerBalance(const StepSnapshot &snapshot, const std::vector<BaseSaturation> &oversaturated, const std::vector<BaseSaturation> &undersaturated, const UnitRegistry &units,
+                       std::vector<WorkerTransfer> &transfers);
+
+// Queues every analysis as an independent task on the pool. The snapshot and analysis must stay
+// untouched until the pool has finished them.
+void SubmitStepAnalysis(ThreadPool &pool, const StepSnapshot &snapshot, StepAnalysis &analysis);
+// Same, but returns when all are done
+void RunStepAnalysis(ThreadPool &pool, const StepSnapshot &snapshot, StepAnalysis &analysis);
+
+#endif
@@ -0,0 +1,52 @@
+#include "StepUnits.h"
+
+#include <algorithm>
+
+namespace {
+UNIT_TYPEID TypeOf(const Unit *unit) { return unit->unit_type; }
+
+bool TypeLess(const Unit *a, const Unit *b) { return TypeOf(a) != TypeOf(b) ? TypeOf(a) < TypeOf(b) : a->tag < b->tag; }
+
+struct TypeOrder { // Heterogeneous compare for equal_range on a type alone
+	bool operator()(const Unit *unit, UNIT_TYPEID type) const { return TypeOf(unit) < type; }
+	bool operator()(UNIT_TYPEID type, const Unit *unit) const { return type < TypeOf(unit); }
+};
+} // namespace
+
+void StepUnits::Refresh(const Units &units, uint32_t game_loop) {
+	all_.assign(units.begin(), units.end());
+	self_.clear();
+	enemy_.clear();
+	neutral_.clear();
+	for (const auto &unit : all_) {
+		switch (unit->alliance) {
+		case Unit::Alliance::Self:
+			self_.push_back(unit);
+			break;
+		case Unit::Alliance::Enemy:
+			enemy_.push_back(unit);
+			break;
+		case Unit::Alliance::Neutral:
+			neutral_.push_back(unit);
+			break;
+		default:
+			break;
+		}
+	}
+	self_by_type_.assign(self_.begin(), self_.end());
+	std::sort(self_by_type_.begin(), self_by_type_.end(), TypeLess); // Tag order keeps the lookups stable between steps
+	game_loop_ = game_loop;
+	valid_ = true;
+}
+
+Units StepUnits::OfType(UNIT_TYPEID type) const {
+	auto range = std::equal_range(self_by_type_.begin(), self_by_type_.end(), type, TypeOrder());
+	return Units(range.first, range.second);
+}
+
+int StepUnits::Count(UNIT_TYPEID type) const {
+	auto range = std::equal_range(self_by_type_.begin(), self_by_type_.end(), type, TypeOrder());
+	return static_cast<int>(range.second - range.first);
+}
+
+size_t StepUnits::CopiedBytes() const { return (all_.size() + self_.size() + enemy_.size() + neutral_.size() + self_by_type_.size()) * sizeof(const Unit *); }
@@ -0,0 +1,38 @@
+#ifndef STEP_UNITS_H
+#define STEP_UNITS_H
+
+#include "sc2api/sc2_api.h"
+
+#include <cstdint>
+
+using namespace sc2;
+
+// The units of one observation, split by alliance and with our own units sorted by type. The
+// lists keep their capacity between steps, so after the first few steps a refresh copies
+// pointers without allocating, and the type lookups the bot runs dozens of times per step are a
+// binary search instead of a GetUnits call that builds and filters a new vector every time.
+class StepUnits {
+  public:
+	void Refresh(const Units &units, uint32_t game_loop); // Every unit of the observation
+	bool IsCurrent(uint32_t game_loop) const { return valid_ && game_loop == game_loop_; }
+	void Invalidate() { valid_ = false; } // New game, the next refresh must not be skipped
+
+	const Units &All() const { return all_; }
+	const Units &Self() const { return self_; }
+	const Units &Enemy() const { return enemy_; }
+	const Units &Neutral() const { return neutral_; }
+	Units OfType(UNIT_TYPEID type) const; // Own units of one type
+	int Count(UNIT_TYPEID type) const;
+	size_t CopiedBytes() const; // Pointer bytes the last refresh copied into the lists
+
+  private:
+	Units all_;
+	Units self_;
+	Units enemy_;
+	Units neutral_;
+	Units self_by_type_; // Own units ordered by type, then tag
+	uint32_t game_loop_ = 0;
+	bool valid_ = false;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int workers) : queued_(0), unfinished_(0), next_queue_(0) {
+	for (unsigned int i = 0; i <= workers; ++i) {
+		queues_.emplace_back(new Queue());
+	}
+	for (unsigned int i = 1; i <= workers; ++i) {
+		workers_.emplace_back(&ThreadPool::WorkerLoop, this, static_cast<size_t>(i));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex_);
+		stop_ = true;
+	}
+	wake_.notify_all();
+	for (auto &worker : workers_) {
+		worker.join();
+	}
+}
+
+unsigned int ThreadPool::DefaultWorkers() {
+	unsigned int hardware = std::thread::hardware_concurrency();
+	return hardware > 1 ? hardware - 1 : 0;
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+	size_t home = next_queue_.fetch_add(1) % queues_.size(); // Spread tasks round robin, stealing evens out the rest
+	unfinished_.fetch_add(1);
+	{
+		std::lock_guard<std::mutex> lock(queues_[home]->mutex);
+		queues_[home]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex_);
+		queued_.fetch_add(1);
+	}
+	wake_.notify_one();
+}
+
+void ThreadPool::Wait() {
+	while (unfinished_.load() > 0) {
+		if (!TryRunOne(0)) {
+			std::this_thread::yield(); // Remaining tasks are running on workers
+		}
+	}
+}
+
+bool ThreadPool::Idle() const { return unfinished_.load() == 0; }
+
+bool ThreadPool::TryRunOne(size_t home) {
+	std::function<void()> task;
+	for (size_t i = 0; i < queues_.size() && !task; ++i) {
+		Queue &queue = *queues_[(home + i) % queues_.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty()) {
+			continue;
+		}
+		if (i == 0) { // Own queue, newest first for cache locality
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		} else { // Steal the oldest task
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+	}
+	if (!task) {
+		return false;
+	}
+
+	queued_.fetch_sub(1);
+	task();
+	unfinished_.fetch_sub(1);
+	return true;
+}
+
+void ThreadPool::WorkerLoop(size_t home) {
+	for (;;) {
+		if (TryRunOne(home)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(wake_mutex_);
+		wake_.wait(lock, [this]() { return stop_ || queued_.load() > 0; });
+		if (stop_) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Each worker owns a queue and pops from its back, idle workers steal
+// from the front of the others. The thread that calls Wait owns queue 0 and helps run tasks, so a
+// pool with zero workers still runs everything, just serially.
+class ThreadPool {
+  public:
+	explicit ThreadPool(unsigned int workers); // Worker threads besides the caller
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	void Submit(std::function<void()> task);
+	void Wait();       // Runs tasks on the calling thread until every submitted task has finished
+	bool Idle() const; // True when no submitted task is queued or running
+	int Queued() const { return queued_.load(std::memory_order_relaxed); }
+
+	size_t Size() const { return workers_.size(); }
+	static unsigned int DefaultWorkers(); // One less than the hardware threads, the game thread is the last one
+
+  private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	bool TryRunOne(size_t home);
+	void WorkerLoop(size_t home);
+
+	std::vector<std::unique_ptr<Queue>> queues_;
+	std::vector<std::thread> workers_;
+	std::mutex wake_mutex_;
+	std::condition_variable wake_;
+	std::atomic<int> queued_;     // Submitted, not yet started
+	std::atomic<int> unfinished_; // Submitted, not yet finished
+	std::atomic<size_t> next_queue_;
+	bool stop_ = false; // Guarded by wake_mutex_
+};
+
+#endif
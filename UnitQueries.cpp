@@ -0,0 +1,55 @@
+#include "UnitQueries.h"
+
+#include <limits>
+
+Units UnitsOfType(const Units &units, UNIT_TYPEID type) {
+	Units units_vector;
+	for (const auto &unit : units) {
+		if (unit->unit_type == type) {    // If unit of the same type
+			units_vector.push_back(unit); // Push to the vector
+		}
+	}
+	return units_vector;
+}
+
+const Unit *NearestMineralPatch(const Units &units, const Point2D &start) {
+	float closest_distance = std::numeric_limits<float>::max();
+	const Unit *target = nullptr;
+	for (const auto &u : units) {
+		if (IsMineralField(u->unit_type) && u->mineral_contents > 0) {
+			float distance = DistanceSquared2D(u->pos, start);
+			if (distance < closest_distance) {
+				closest_distance = distance;
+				target = u;
+			}
+		}
+	}
+	return target;
+}
+
+const Unit *NearestFreeGeyser(const Units &neutral_units, const Units &units, const Point2D &start) {
+	float closest_distance = std::numeric_limits<float>::max();
+	const Unit *target = nullptr;
+	for (const auto &geyser : neutral_units) {
+		if (!IsVespeneGeyser(geyser->unit_type)) {
+			continue;
+		}
+
+		bool geyser_occupied = false; // Check for if vespene gyser is taken
+		for (const auto &unit : units) {
+			if (unit->unit_type == UNIT_TYPEID::ZERG_EXTRACTOR && DistanceSquared2D(unit->pos, geyser->pos) < 1.0f) {
+				geyser_occupied = true;
+				break;
+			}
+		}
+
+		if (!geyser_occupied) {
+			float distance = DistanceSquared2D(geyser->pos, start);
+			if (distance < closest_distance) {
+				closest_distance = distance;
+				target = geyser;
+			}
+		}
+	}
+	return target;
+}
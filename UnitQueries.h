@@ -0,0 +1,16 @@
+#ifndef UNIT_QUERIES_H
+#define UNIT_QUERIES_H
+
+#include "sc2api/sc2_api.h"
+
+#include "ZergData.h"
+
+using namespace sc2;
+
+// Unit list queries the bot runs every step. They take the unit list instead of the observation
+// so tools/Benchmark can time them on synthetic games. Type checks come from ZergData.h.
+Units UnitsOfType(const Units &units, UNIT_TYPEID type);
+const Unit *NearestMineralPatch(const Units &units, const Point2D &start);                    // Closest mineral field with minerals left
+const Unit *NearestFreeGeyser(const Units &neutral_units, const Units &units, const Point2D &start); // Closest geyser without an extractor from units on it
+
+#endif
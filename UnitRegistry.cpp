@@ -0,0 +1,142 @@
+#include "UnitRegistry.h"
+
+#include <algorithm>
+
+namespace {
+const UnitRecord kEmptyRecord = {NullTag, NullTag, 0, UnitRole::None, 0};
+} // namespace
+
+UnitRegistry::UnitRegistry(size_t capacity) {
+	size_t slots = 16;
+	shift_ = 60;
+	while (slots < capacity) {
+		slots <<= 1;
+		shift_--;
+	}
+	slots_.assign(slots, kEmptyRecord);
+	mask_ = slots - 1;
+}
+
+UnitRecord *UnitRegistry::Find(Tag tag) {
+	if (tag == NullTag) {
+		return nullptr;
+	}
+	for (size_t slot = Slot(tag);; slot = (slot + 1) & mask_) {
+		if (slots_[slot].tag == tag) {
+			return &slots_[slot];
+		}
+		if (slots_[slot].tag == NullTag) {
+			return nullptr;
+		}
+	}
+}
+
+const UnitRecord *UnitRegistry::Find(Tag tag) const { return const_cast<UnitRegistry *>(this)->Find(tag); }
+
+UnitRecord &UnitRegistry::Get(Tag tag) {
+	if ((size_ + 1) * 10 > slots_.size() * 7) { // Keep the load under 70%, probe runs grow quickly past that
+		Grow();
+	}
+	size_t slot = Slot(tag);
+	while (slots_[slot].tag != NullTag) {
+		if (slots_[slot].tag == tag) {
+			return slots_[slot];
+		}
+		slot = (slot + 1) & mask_;
+	}
+	slots_[slot] = kEmptyRecord;
+	slots_[slot].tag = tag;
+	size_++;
+	return slots_[slot];
+}
+
+UnitRole UnitRegistry::Role(Tag tag) const {
+	const UnitRecord *record = Find(tag);
+	return record ? record->role : UnitRole::None;
+}
+
+void UnitRegistry::Assign(Tag tag, UnitRole role, Tag target, uint32_t game_loop) {
+	if (tag == NullTag) {
+		return;
+	}
+	UnitRecord &record = Get(tag);
+	if (record.target != target) {
+		Unlink(tag, record.target);
+		if (target != NullTag) {
+			by_target_.emplace(target, tag);
+		}
+	}
+	record.role = role;
+	record.target = target;
+	record.since_loop = game_loop;
+}
+
+int UnitRegistry::CountRole(UnitRole role, Tag target, uint32_t since_loop) const {
+	if (target == NullTag) {
+		return 0;
+	}
+	int count = 0;
+	auto range = by_target_.equal_range(target);
+	for (auto it = range.first; it != range.second; ++it) {
+		const UnitRecord *record = Find(it->second);
+		if (record && record->role == role && record->since_loop >= since_loop) {
+			count++;
+		}
+	}
+	return count;
+}
+
+bool UnitRegistry::Erase(Tag tag) {
+	UnitRecord *record = Find(tag);
+	if (!record) {
+		return false;
+	}
+	Unlink(tag, record->target);
+
+	// Shift later entries of the probe run back into the hole, unless they already sit at or after
+	// their home slot relative to it
+	size_t hole = static_cast<size_t>(record - slots_.data());
+	for (size_t slot = (hole + 1) & mask_; slots_[slot].tag != NullTag; slot = (slot + 1) & mask_) {
+		size_t home = Slot(slots_[slot].tag);
+		if (((slot - home) & mask_) >= ((slot - hole) & mask_)) {
+			slots_[hole] = slots_[slot];
+			hole = slot;
+		}
+	}
+	slots_[hole] = kEmptyRecord;
+	size_--;
+	return true;
+}
+
+void UnitRegistry::Clear() {
+	std::fill(slots_.begin(), slots_.end(), kEmptyRecord);
+	by_target_.clear();
+	size_ = 0;
+}
+
+void UnitRegistry::Grow() {
+	std::vector<UnitRecord> old_slots;
+	old_slots.swap(slots_);
+	slots_.assign(old_slots.size() * 2, kEmptyRecord);
+	mask_ = slots_.size() - 1;
+	shift_--;
+	size_ = 0;
+	for (const auto &record : old_slots) {
+		if (record.tag != NullTag) {
+			Get(record.tag) = record;
+		}
+	}
+}
+
+void UnitRegistry::Unlink(Tag tag, Tag target) {
+	if (target == NullTag) {
+		return;
+	}
+	auto range = by_target_.equal_range(target);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second == tag) {
+			by_target_.erase(it);
+			return;
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#ifndef UNIT_REGISTRY_H
+#define UNIT_REGISTRY_H
+
+#include "sc2api/sc2_api.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace sc2;
+
+// What a unit is currently doing for the bot. Subsystems claim units by setting a role, so two
+// of them never hand the same unit different orders in one step.
+enum class UnitRole : uint8_t {
+	None,
+	Minerals, // Drone mining minerals
+	Gas,      // Drone sent to or mining an extractor, target is the extractor
+	Builder,  // Drone on its way to build, stale after a while if the build never started
+	Army,     // Combat unit in a squad, group is its SquadRole
+	Scout,    // Overlord or zergling owned by the scout planner
+	Count
+};
+
+struct UnitRecord {
+	Tag tag;             // NullTag marks an empty slot
+	Tag target;          // Role specific, NullTag when the role has none
+	uint32_t since_loop; // Game loop the role was assigned
+	UnitRole role;
+	uint8_t group; // Index inside the subsystem that owns the role
+};
+
+// Per-unit state keyed by Tag in a flat open-addressing table. Linear probing keeps lookups in
+// one or two cache lines and erase shifts the following entries back, so there are no tombstones
+// and lookups stay short however many units died. Units with a target are also indexed by it, so
+// counting the units on one extractor reads only those units.
+class UnitRegistry {
+  public:
+	explicit UnitRegistry(size_t capacity = 256);
+
+	UnitRecord *Find(Tag tag);
+	const UnitRecord *Find(Tag tag) const;
+	UnitRecord &Get(Tag tag); // Inserts a record with no role when the unit is new, change role and target through Assign
+
+	UnitRole Role(Tag tag) const;
+	void Assign(Tag tag, UnitRole role, Tag target, uint32_t game_loop);
+	int CountRole(UnitRole role, Tag target, uint32_t since_loop) const; // Units given the role on the target at or after since_loop, 0 for NullTag
+
+	bool Erase(Tag tag);
+	template <class Predicate> size_t EraseIf(Predicate predicate); // Predicate takes a const UnitRecord &
+	void Clear();
+	size_t Size() const { return size_; }
+
+  private:
+	size_t Slot(Tag tag) const { return static_cast<size_t>((tag * 0x9E3779B97F4A7C15ull) >> shift_); } // Fibonacci hashing, tags are not uniform in the low bits
+	void Grow();
+	void Unlink(Tag tag, Tag target); // Drops the unit from the target index
+
+	std::vector<UnitRecord> slots_;
+	std::vector<Tag> erase_scratch_;
+	std::unordered_multimap<Tag, Tag> by_target_; // Target to the units that have it, a handful each
+	size_t size_ = 0;
+	size_t mask_ = 0;
+	int shift_ = 0;
+};
+
+template <class Predicate> size_t UnitRegistry::EraseIf(Predicate predicate) {
+	erase_scratch_.clear(); // Erasing shifts entries, so collect the tags first
+	for (const auto &record : slots_) {
+		if (record.tag != NullTag && predicate(record)) {
+			erase_scratch_.push_back(record.tag);
+		}
+	}
+	for (Tag tag : erase_scratch_) {
+		Erase(tag);
+	}
+	return erase_scratch_.size();
+}
+
+#endif
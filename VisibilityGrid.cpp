@@ -0,0 +1,91 @@
+#include "VisibilityGrid.h"
+
+#include <bitset>
+#include <cstring>
+
+namespace {
+const uint8_t kVisible = 2; // Raw layer values: 0 hidden, 1 fogged, 2 visible
+} // namespace
+
+void VisibilityGrid::Reset(const GameInfo &game_info) {
+	width_ = game_info.width;
+	height_ = game_info.height;
+	words_per_row_ = (width_ + 63) / 64;
+	visible_.assign(static_cast<size_t>(words_per_row_) * height_, 0);
+	last_seen_.assign(static_cast<size_t>(width_) * height_, 0);
+	previous_.assign(static_cast<size_t>(width_) * height_, 0); // All hidden, so the first update sees every visible tile change
+	changed_tiles_ = 0;
+}
+
+int VisibilityGrid::Update(const std::string &visibility, int bits_per_pixel, uint32_t game_loop) {
+	changed_tiles_ = 0;
+	if (width_ == 0 || bits_per_pixel != 8 || visibility.size() < previous_.size()) { // Not this map's layer
+		return 0;
+	}
+
+	const uint8_t *layer = reinterpret_cast<const uint8_t *>(visibility.data());
+	for (int row = 0; row < height_; ++row) {
+		size_t offset = static_cast<size_t>(row) * width_;
+		if (std::memcmp(layer + offset, &previous_[offset], width_) != 0) {
+			UpdateRow(layer, row, game_loop);
+		}
+	}
+	return changed_tiles_;
+}
+
+void VisibilityGrid::UpdateRow(const uint8_t *layer, int row, uint32_t game_loop) {
+	size_t offset = static_cast<size_t>(row) * width_;
+	const uint8_t *now = layer + offset;
+	uint8_t *before = reinterpret_cast<uint8_t *>(&previous_[offset]);
+	int y = height_ - 1 - row; // Image origin is the top left, the map origin the bottom left
+	uint64_t *words = &visible_[y * words_per_row_];
+	uint32_t *last_seen = &last_seen_[static_cast<size_t>(y) * width_];
+
+	for (int x0 = 0; x0 < width_; x0 += 8) {
+		int count = width_ - x0 < 8 ? width_ - x0 : 8;
+		uint64_t now_tiles = 0;
+		uint64_t before_tiles = 0;
+		std::memcpy(&now_tiles, now + x0, count);
+		std::memcpy(&before_tiles, before + x0, count);
+		if (now_tiles == before_tiles) {
+			continue;
+		}
+		for (int x = x0; x < x0 + count; ++x) {
+			bool visible = now[x] == kVisible;
+			if (visible == (before[x] == kVisible)) { // Hidden to fogged and back
+				continue;
+			}
+			uint64_t bit = uint64_t(1) << (x & 63);
+			if (visible) {
+				words[x >> 6] |= bit;
+			} else {
+				words[x >> 6] &= ~bit;
+				last_seen[x] = game_loop;
+			}
+			changed_tiles_++;
+		}
+		std::memcpy(before + x0, now + x0, count);
+	}
+}
+
+bool VisibilityGrid::IsVisible(int x, int y) const { return Valid(x, y) && ((visible_[y * words_per_row_ + (x >> 6)] >> (x & 63)) & 1); }
+
+bool VisibilityGrid::IsVisible(const Point2D &point) const { return IsVisible(static_cast<int>(point.x), static_cast<int>(point.y)); }
+
+uint32_t VisibilityGrid::Age(const Point2D &point, uint32_t game_loop) const {
+	int x = static_cast<int>(point.x);
+	int y = static_cast<int>(point.y);
+	if (!Valid(x, y) || IsVisible(x, y)) {
+		return 0;
+	}
+	uint32_t last_seen = last_seen_[static_cast<size_t>(y) * width_ + x];
+	return game_loop > last_seen ? game_loop - last_seen : 0;
+}
+
+int VisibilityGrid::VisibleTiles() const {
+	int tiles = 0;
+	for (uint64_t word : visible_) {
+		tiles += static_cast<int>(std::bitset<64>(word).count());
+	}
+	return tiles;
+}
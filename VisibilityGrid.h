@@ -0,0 +1,41 @@
+#ifndef VISIBILITY_GRID_H
+#define VISIBILITY_GRID_H
+
+#include "sc2api/sc2_api.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace sc2;
+
+// What we see of the map and for how long each tile has been out of sight. Visible tiles are a
+// packed bitset, 64 tiles per word with rows padded to whole words, next to the loop each tile
+// was last seen on. Update compares the raw visibility layer with the last one a row and then
+// eight tiles at a time, and only touches the tiles whose state changed. Ages are computed when
+// asked for, so a step where vision stands still costs one memcmp per row.
+class VisibilityGrid {
+  public:
+	void Reset(const GameInfo &game_info);
+	int Update(const std::string &visibility, int bits_per_pixel, uint32_t game_loop); // Visibility layer of the raw map state, returns the tiles that changed
+
+	bool IsVisible(int x, int y) const;
+	bool IsVisible(const Point2D &point) const;
+	uint32_t Age(const Point2D &point, uint32_t game_loop) const; // Loops since the tile was last visible, 0 while visible, the game time if never seen
+	int ChangedTiles() const { return changed_tiles_; }
+	int VisibleTiles() const;
+
+  private:
+	bool Valid(int x, int y) const { return x >= 0 && y >= 0 && x < width_ && y < height_; }
+	void UpdateRow(const uint8_t *layer, int row, uint32_t game_loop); // Image row, previous_ still holds the last layer
+
+	int width_ = 0;
+	int height_ = 0;
+	int words_per_row_ = 0;
+	int changed_tiles_ = 0;
+	std::vector<uint64_t> visible_;
+	std::vector<uint32_t> last_seen_; // Per tile, the loop it was last visible on
+	std::string previous_;            // Raw layer of the last update, one byte per tile
+};
+
+#endif
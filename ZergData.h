@@ -0,0 +1,141 @@
+#ifndef ZERG_DATA_H
+#define ZERG_DATA_H
+
+#include "sc2api/sc2_typeenums.h"
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace sc2;
+
+// Category bits of a unit type, several can be set
+enum UnitFlag : uint16_t {
+	kUnitCombat = 1 << 0,      // Army unit, rallies and attacks
+	kUnitStructure = 1 << 1,   // Built by a drone or morphed from one
+	kUnitTownHall = 1 << 2,    // Hatchery, lair and hive
+	kUnitWorker = 1 << 3,      // Drone
+	kUnitFlying = 1 << 4,      // Air unit
+	kUnitFromLarva = 1 << 5,   // Trained from larva
+	kUnitMorph = 1 << 6,       // Morphed from the producer, which is used up or replaced
+	kUnitMineralField = 1 << 7,
+	kUnitGeyser = 1 << 8,
+};
+
+// Cost and tech of one Zerg unit type, values are for one order at LotV balance. A zergling order
+// makes two zerglings, and the cost of a morph is what the morph adds on top of the producer.
+struct ZergUnitData {
+	UNIT_TYPEID type;
+	ABILITY_ID ability; // Trains, builds or morphs the type, INVALID for neutral types
+	int minerals;
+	int vespene;
+	float supply;            // Supply the order adds
+	float build_time;        // Game seconds on faster
+	UNIT_TYPEID producer;    // Larva, drone, or the unit that morphs
+	UNIT_TYPEID requirement; // Structure that must be finished first, a lair is also met by a hive
+	uint16_t flags;
+};
+
+// Entry 0 is returned for types and abilities that are not in the table
+constexpr ZergUnitData kZergUnits[] = {
+    {UNIT_TYPEID::INVALID, ABILITY_ID::INVALID, 0, 0, 0.0f, 0.0f, UNIT_TYPEID::INVALID, UNIT_TYPEID::INVALID, 0},
+
+    // Larva
+    {UNIT_TYPEID::ZERG_DRONE, ABILITY_ID::TRAIN_DRONE, 50, 0, 1.0f, 12.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::INVALID, kUnitWorker | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_OVERLORD, ABILITY_ID::TRAIN_OVERLORD, 100, 0, 0.0f, 18.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::INVALID, kUnitFlying | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_ZERGLING, ABILITY_ID::TRAIN_ZERGLING, 50, 0, 1.0f, 17.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::ZERG_SPAWNINGPOOL, kUnitCombat | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_ROACH, ABILITY_ID::TRAIN_ROACH, 75, 25, 2.0f, 19.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::ZERG_ROACHWARREN, kUnitCombat | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_HYDRALISK, ABILITY_ID::TRAIN_HYDRALISK, 100, 50, 2.0f, 24.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::ZERG_HYDRALISKDEN, kUnitCombat | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_MUTALISK, ABILITY_ID::TRAIN_MUTALISK, 100, 100, 2.0f, 24.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::ZERG_SPIRE, kUnitCombat | kUnitFlying | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_CORRUPTOR, ABILITY_ID::TRAIN_CORRUPTOR, 150, 100, 2.0f, 29.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::ZERG_SPIRE, kUnitCombat | kUnitFlying | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_INFESTOR, ABILITY_ID::TRAIN_INFESTOR, 100, 150, 2.0f, 36.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::ZERG_INFESTATIONPIT, kUnitCombat | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_SWARMHOSTMP, ABILITY_ID::TRAIN_SWARMHOST, 100, 75, 3.0f, 29.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::ZERG_INFESTATIONPIT, kUnitCombat | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_ULTRALISK, ABILITY_ID::TRAIN_ULTRALISK, 275, 200, 6.0f, 39.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::ZERG_ULTRALISKCAVERN, kUnitCombat | kUnitFromLarva},
+    {UNIT_TYPEID::ZERG_VIPER, ABILITY_ID::TRAIN_VIPER, 100, 200, 3.0f, 29.0f, UNIT_TYPEID::ZERG_LARVA, UNIT_TYPEID::ZERG_HIVE, kUnitCombat | kUnitFlying | kUnitFromLarva},
+
+    // Hatchery
+    {UNIT_TYPEID::ZERG_QUEEN, ABILITY_ID::TRAIN_QUEEN, 150, 0, 2.0f, 36.0f, UNIT_TYPEID::ZERG_HATCHERY, UNIT_TYPEID::ZERG_SPAWNINGPOOL, 0},
+
+    // Unit morphs
+    {UNIT_TYPEID::ZERG_RAVAGER, ABILITY_ID::MORPH_RAVAGER, 25, 75, 1.0f, 9.0f, UNIT_TYPEID::ZERG_ROACH, UNIT_TYPEID::ZERG_ROACHWARREN, kUnitCombat | kUnitMorph},
+    {UNIT_TYPEID::ZERG_BANELING, ABILITY_ID::TRAIN_BANELING, 25, 25, 0.0f, 14.0f, UNIT_TYPEID::ZERG_ZERGLING, UNIT_TYPEID::ZERG_BANELINGNEST, kUnitCombat | kUnitMorph},
+    {UNIT_TYPEID::ZERG_LURKERMP, ABILITY_ID::MORPH_LURKER, 50, 100, 1.0f, 18.0f, UNIT_TYPEID::ZERG_HYDRALISK, UNIT_TYPEID::ZERG_LURKERDENMP, kUnitCombat | kUnitMorph},
+    {UNIT_TYPEID::ZERG_BROODLORD, ABILITY_ID::MORPH_BROODLORD, 150, 150, 2.0f, 24.0f, UNIT_TYPEID::ZERG_CORRUPTOR, UNIT_TYPEID::ZERG_GREATERSPIRE, kUnitCombat | kUnitFlying | kUnitMorph},
+    {UNIT_TYPEID::ZERG_OVERSEER, ABILITY_ID::MORPH_OVERSEER, 50, 50, 0.0f, 12.0f, UNIT_TYPEID::ZERG_OVERLORD, UNIT_TYPEID::ZERG_LAIR, kUnitFlying | kUnitMorph},
+
+    // Drone
+    {UNIT_TYPEID::ZERG_HATCHERY, ABILITY_ID::BUILD_HATCHERY, 300, 0, 0.0f, 71.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::INVALID, kUnitStructure | kUnitTownHall},
+    {UNIT_TYPEID::ZERG_EXTRACTOR, ABILITY_ID::BUILD_EXTRACTOR, 25, 0, 0.0f, 21.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::INVALID, kUnitStructure},
+    {UNIT_TYPEID::ZERG_SPAWNINGPOOL, ABILITY_ID::BUILD_SPAWNINGPOOL, 200, 0, 0.0f, 46.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::INVALID, kUnitStructure},
+    {UNIT_TYPEID::ZERG_EVOLUTIONCHAMBER, ABILITY_ID::BUILD_EVOLUTIONCHAMBER, 75, 0, 0.0f, 25.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::INVALID, kUnitStructure},
+    {UNIT_TYPEID::ZERG_ROACHWARREN, ABILITY_ID::BUILD_ROACHWARREN, 150, 0, 0.0f, 39.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_SPAWNINGPOOL, kUnitStructure},
+    {UNIT_TYPEID::ZERG_BANELINGNEST, ABILITY_ID::BUILD_BANELINGNEST, 100, 50, 0.0f, 43.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_SPAWNINGPOOL, kUnitStructure},
+    {UNIT_TYPEID::ZERG_SPINECRAWLER, ABILITY_ID::BUILD_SPINECRAWLER, 100, 0, 0.0f, 36.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_SPAWNINGPOOL, kUnitStructure},
+    {UNIT_TYPEID::ZERG_SPORECRAWLER, ABILITY_ID::BUILD_SPORECRAWLER, 75, 0, 0.0f, 21.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_SPAWNINGPOOL, kUnitStructure},
+    {UNIT_TYPEID::ZERG_HYDRALISKDEN, ABILITY_ID::BUILD_HYDRALISKDEN, 100, 100, 0.0f, 29.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_LAIR, kUnitStructure},
+    {UNIT_TYPEID::ZERG_LURKERDENMP, ABILITY_ID::BUILD_LURKERDEN, 100, 150, 0.0f, 57.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_HYDRALISKDEN, kUnitStructure},
+    {UNIT_TYPEID::ZERG_SPIRE, ABILITY_ID::BUILD_SPIRE, 200, 200, 0.0f, 71.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_LAIR, kUnitStructure},
+    {UNIT_TYPEID::ZERG_INFESTATIONPIT, ABILITY_ID::BUILD_INFESTATIONPIT, 100, 100, 0.0f, 36.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_LAIR, kUnitStructure},
+    {UNIT_TYPEID::ZERG_NYDUSNETWORK, ABILITY_ID::BUILD_NYDUSNETWORK, 150, 150, 0.0f, 36.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_LAIR, kUnitStructure},
+    {UNIT_TYPEID::ZERG_ULTRALISKCAVERN, ABILITY_ID::BUILD_ULTRALISKCAVERN, 150, 200, 0.0f, 46.0f, UNIT_TYPEID::ZERG_DRONE, UNIT_TYPEID::ZERG_HIVE, kUnitStructure},
+
+    // Structure morphs
+    {UNIT_TYPEID::ZERG_LAIR, ABILITY_ID::MORPH_LAIR, 150, 100, 0.0f, 57.0f, UNIT_TYPEID::ZERG_HATCHERY, UNIT_TYPEID::ZERG_SPAWNINGPOOL, kUnitStructure | kUnitTownHall | kUnitMorph},
+    {UNIT_TYPEID::ZERG_HIVE, ABILITY_ID::MORPH_HIVE, 200, 150, 0.0f, 71.0f, UNIT_TYPEID::ZERG_LAIR, UNIT_TYPEID::ZERG_INFESTATIONPIT, kUnitStructure | kUnitTownHall | kUnitMorph},
+    {UNIT_TYPEID::ZERG_GREATERSPIRE, ABILITY_ID::MORPH_GREATERSPIRE, 100, 150, 0.0f, 71.0f, UNIT_TYPEID::ZERG_SPIRE, UNIT_TYPEID::ZERG_HIVE, kUnitStructure | kUnitMorph},
+
+    // Types that are only classified
+    {UNIT_TYPEID::NEUTRAL_MINERALFIELD, ABILITY_ID::INVALID, 0, 0, 0.0f, 0.0f, UNIT_TYPEID::INVALID, UNIT_TYPEID::INVALID, kUnitMineralField},
+    {UNIT_TYPEID::NEUTRAL_MINERALFIELD750, ABILITY_ID::INVALID, 0, 0, 0.0f, 0.0f, UNIT_TYPEID::INVALID, UNIT_TYPEID::INVALID, kUnitMineralField},
+    {UNIT_TYPEID::NEUTRAL_RICHMINERALFIELD, ABILITY_ID::INVALID, 0, 0, 0.0f, 0.0f, UNIT_TYPEID::INVALID, UNIT_TYPEID::INVALID, kUnitMineralField},
+    {UNIT_TYPEID::NEUTRAL_RICHMINERALFIELD750, ABILITY_ID::INVALID, 0, 0, 0.0f, 0.0f, UNIT_TYPEID::INVALID, UNIT_TYPEID::INVALID, kUnitMineralField},
+    {UNIT_TYPEID::NEUTRAL_VESPENEGEYSER, ABILITY_ID::INVALID, 0, 0, 0.0f, 0.0f, UNIT_TYPEID::INVALID, UNIT_TYPEID::INVALID, kUnitGeyser},
+    {UNIT_TYPEID::NEUTRAL_PROTOSSVESPENEGEYSER, ABILITY_ID::INVALID, 0, 0, 0.0f, 0.0f, UNIT_TYPEID::INVALID, UNIT_TYPEID::INVALID, kUnitGeyser},
+    {UNIT_TYPEID::NEUTRAL_SPACEPLATFORMGEYSER, ABILITY_ID::INVALID, 0, 0, 0.0f, 0.0f, UNIT_TYPEID::INVALID, UNIT_TYPEID::INVALID, kUnitGeyser},
+};
+
+constexpr size_t kZergUnitCount = sizeof(kZergUnits) / sizeof(kZergUnits[0]);
+constexpr size_t kMaxUnitTypeId = 2048; // Above every UNIT_TYPEID value
+constexpr size_t kMaxAbilityId = 4096;  // Above every ABILITY_ID value
+
+// Direct-indexed lookups built by the compiler, a type or ability check is one array load
+struct ZergDataIndex {
+	constexpr ZergDataIndex() : by_type(), by_ability(), flags() {
+		for (size_t i = 1; i < kZergUnitCount; ++i) {
+			by_type[static_cast<uint32_t>(kZergUnits[i].type)] = static_cast<uint8_t>(i);
+			flags[static_cast<uint32_t>(kZergUnits[i].type)] = kZergUnits[i].flags;
+			if (kZergUnits[i].ability != ABILITY_ID::INVALID) {
+				by_ability[static_cast<uint32_t>(kZergUnits[i].ability)] = static_cast<uint8_t>(i);
+			}
+		}
+	}
+
+	uint8_t by_type[kMaxUnitTypeId];
+	uint8_t by_ability[kMaxAbilityId];
+	uint16_t flags[kMaxUnitTypeId];
+};
+
+constexpr ZergDataIndex kZergDataIndex;
+static_assert(kZergUnitCount < 256, "Zerg table indices must fit in uint8_t");
+
+constexpr const ZergUnitData &UnitData(UNIT_TYPEID type) {
+	return static_cast<uint32_t>(type) < kMaxUnitTypeId ? kZergUnits[kZergDataIndex.by_type[static_cast<uint32_t>(type)]] : kZergUnits[0];
+}
+
+constexpr const ZergUnitData &AbilityData(ABILITY_ID ability) { // The unit the ability makes
+	return static_cast<uint32_t>(ability) < kMaxAbilityId ? kZergUnits[kZergDataIndex.by_ability[static_cast<uint32_t>(ability)]] : kZergUnits[0];
+}
+
+constexpr bool HasUnitFlag(UNIT_TYPEID type, uint16_t flag) {
+	return static_cast<uint32_t>(type) < kMaxUnitTypeId && (kZergDataIndex.flags[static_cast<uint32_t>(type)] & flag) != 0;
+}
+
+constexpr bool IsMineralField(UNIT_TYPEID type) { return HasUnitFlag(type, kUnitMineralField); }
+constexpr bool IsVespeneGeyser(UNIT_TYPEID type) { return HasUnitFlag(type, kUnitGeyser); }
+constexpr bool IsTownHall(UNIT_TYPEID type) { return HasUnitFlag(type, kUnitTownHall); }
+constexpr bool IsCombatUnitType(UNIT_TYPEID type) { return HasUnitFlag(type, kUnitCombat); }
+
+static_assert(UnitData(UNIT_TYPEID::ZERG_ROACH).vespene == 25, "Zerg table index is broken");
+static_assert(AbilityData(ABILITY_ID::MORPH_RAVAGER).type == UNIT_TYPEID::ZERG_RAVAGER, "Zerg table index is broken");
+static_assert(IsTownHall(UNIT_TYPEID::ZERG_LAIR) && !IsCombatUnitType(UNIT_TYPEID::ZERG_QUEEN), "Zerg table flags are broken");
+
+#endif
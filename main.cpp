@@ -10,6 +10,15 @@
 // LadderInterface allows the bot to be tested against the built-in AI or
 // played against other bots
 int main(int argc, char *argv[]) {
-	RunBot(argc, argv, new BasicSc2Bot(), sc2::Race::Zerg);
+	BasicSc2Bot *bot = new BasicSc2Bot();
+	RunBot(argc, argv, bot, sc2::Race::Zerg, [bot](const ConnectionOptions &options) {
+		bot->SetPipelined(options.Pipelined);
+		if (!options.TraceFile.empty()) {
+			bot->EnableTrace(options.TraceFile);
+		}
+		if (options.MetricsPort > 0) {
+			bot->EnableMetrics(options.MetricsPort);
+		}
+	});
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "SyntheticGame.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+const int kMapSize = 192;
+const float kCreepRadius = 12.0f;
+const UNIT_TYPEID kArmyTypes[] = {UNIT_TYPEID::ZERG_ZERGLING, UNIT_TYPEID::ZERG_ROACH, UNIT_TYPEID::ZERG_HYDRALISK, UNIT_TYPEID::ZERG_MUTALISK, UNIT_TYPEID::ZERG_RAVAGER};
+const UNIT_TYPEID kStructureTypes[] = {UNIT_TYPEID::ZERG_SPAWNINGPOOL, UNIT_TYPEID::ZERG_ROACHWARREN, UNIT_TYPEID::ZERG_EVOLUTIONCHAMBER, UNIT_TYPEID::ZERG_SPINECRAWLER};
+const UNIT_TYPEID kEnemyTypes[] = {UNIT_TYPEID::TERRAN_MARINE, UNIT_TYPEID::TERRAN_MARAUDER, UNIT_TYPEID::TERRAN_SIEGETANKSIEGED, UNIT_TYPEID::TERRAN_SUPPLYDEPOT};
+
+std::string FullImage(int width, int height) { return std::string(static_cast<size_t>(width * height + 7) / 8, static_cast<char>(0xff)); }
+} // namespace
+
+SyntheticGame::SyntheticGame(const SyntheticGameOptions &options) {
+	std::mt19937 random(options.seed);
+	std::uniform_real_distribution<float> coordinate(8.0f, kMapSize - 8.0f);
+	std::uniform_real_distribution<float> unit_offset(-6.0f, 6.0f);
+
+	int bases = options.bases > 0 ? options.bases : std::max(1, std::min(options.units / 100, 16));
+	int enemies = options.units * 3 / 10;
+	int own = std::max(options.units - enemies - bases, 0);
+	storage_.reserve(options.units + bases * (options.minerals_per_base + options.geysers_per_base * 2) + 16);
+
+	// Bases on a grid, each with its mineral line, geysers and an extractor on the first geyser
+	std::vector<Point2D> base_positions;
+	int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(bases))));
+	float spacing = (kMapSize - 32.0f) / columns;
+	for (int i = 0; i < bases; ++i) {
+		Point2D pos(24.5f + (i % columns) * spacing, 24.5f + (i / columns) * spacing);
+		base_positions.push_back(pos);
+		Unit &base = AddUnit(Unit::Alliance::Self, i % 3 == 1 ? UNIT_TYPEID::ZERG_LAIR : UNIT_TYPEID::ZERG_HATCHERY, pos);
+		base.ideal_harvesters = 16;
+		base.assigned_harvesters = static_cast<int>(random() % 25); // Some under, some over saturated
+		for (int m = 0; m < options.minerals_per_base; ++m) {
+			float angle = 3.14159f * m / std::max(options.minerals_per_base - 1, 1);
+			Unit &mineral = AddUnit(Unit::Alliance::Neutral, m % 4 == 0 ? UNIT_TYPEID::NEUTRAL_RICHMINERALFIELD : UNIT_TYPEID::NEUTRAL_MINERALFIELD,
+			                        Point2D(pos.x + 7.0f * std::cos(angle), pos.y + 7.0f * std::sin(angle)));
+			mineral.mineral_contents = 1800;
+		}
+		for (int g = 0; g < options.geysers_per_base; ++g) {
+			Point2D geyser_pos(pos.x - 7.0f + 14.0f * g, pos.y - 5.0f);
+			AddUnit(Unit::Alliance::Neutral, UNIT_TYPEID::NEUTRAL_VESPENEGEYSER, geyser_pos);
+			if (g == 0) {
+				AddUnit(Unit::Alliance::Self, UNIT_TYPEID::ZERG_EXTRACTOR, geyser_pos);
+			}
+		}
+	}
+	start_location_ = base_positions.front();
+
+	// Our units: half drones mining at a base, the rest army and structures
+	UnitOrder gather;
+	gather.ability_id = ABILITY_ID::HARVEST_GATHER;
+	for (int i = 0; i < own; ++i) {
+		const Point2D &base = base_positions[i % bases];
+		Point2D pos(base.x + unit_offset(random), base.y + unit_offset(random));
+		if (i % 2 == 0) {
+			Unit &drone = AddUnit(Unit::Alliance::Self, UNIT_TYPEID::ZERG_DRONE, pos);
+			if (i % 8 != 0) {
+				drone.orders.push_back(gather);
+			}
+		} else if (i % 10 == 1) {
+			AddUnit(Unit::Alliance::Self, kStructureTypes[(i / 10) % 4], Point2D(base.x + 5.0f + (i % 4) * 3.0f, base.y + 5.0f));
+		} else {
+			AddUnit(Unit::Alliance::Self, kArmyTypes[i % 5], Point2D(coordinate(random), coordinate(random)));
+		}
+	}
+	for (int i = 0; i < enemies; ++i) { // Every fourth enemy pushes into one of our bases
+		Point2D pos = i % 4 == 0 ? base_positions[i % bases] + Point2D(unit_offset(random), unit_offset(random)) : Point2D(coordinate(random), coordinate(random));
+		Unit &enemy = AddUnit(Unit::Alliance::Enemy, kEnemyTypes[i % 4], pos);
+		enemy.shield = 0.0f;
+	}
+
+	// Open map with creep around every base
+	game_info_.width = kMapSize;
+	game_info_.height = kMapSize;
+	game_info_.pathing_grid.width = kMapSize;
+	game_info_.pathing_grid.height = kMapSize;
+	game_info_.pathing_grid.bits_per_pixel = 1;
+	game_info_.pathing_grid.data = FullImage(kMapSize, kMapSize);
+	game_info_.placement_grid = game_info_.pathing_grid;
+	creep_.assign(static_cast<size_t>(kMapSize * kMapSize + 7) / 8, 0);
+	for (int row = 0; row < kMapSize; ++row) {
+		for (int x = 0; x < kMapSize; ++x) {
+			Point2D tile(x + 0.5f, kMapSize - 1 - row + 0.5f); // Image rows start at the top of the map
+			for (const auto &base : base_positions) {
+				if (DistanceSquared2D(tile, base) < kCreepRadius * kCreepRadius) {
+					int index = row * kMapSize + x;
+					creep_[index >> 3] = static_cast<char>(creep_[index >> 3] | (0x80 >> (index & 7)));
+					break;
+				}
+			}
+		}
+	}
+}
+
+const Unit *SyntheticGame::GetUnit(Tag tag) const { // Tags are handed out in storage order, so the tag is the index
+	if (tag < kFirstTag || (tag - kFirstTag) % kTagStride != 0) {
+		return nullptr;
+	}
+	size_t index = static_cast<size_t>((tag - kFirstTag) / kTagStride);
+	return index < storage_.size() ? &storage_[index] : nullptr;
+}
+
+Unit &SyntheticGame::AddUnit(Unit::Alliance alliance, UNIT_TYPEID type, const Point2D &pos) {
+	storage_.emplace_back();
+	Unit &unit = storage_.back();
+	unit.alliance = alliance;
+	unit.display_type = Unit::DisplayType::Visible;
+	unit.tag = next_tag_;
+	next_tag_ += kTagStride;
+	unit.unit_type = type;
+	unit.pos = Point3D(pos.x, pos.y, 10.0f);
+	unit.radius = 0.5f;
+	unit.build_progress = 1.0f;
+	unit.is_alive = true;
+	unit.health = unit.health_max = 100.0f;
+	unit.shield = 0.0f;
+	unit.mineral_contents = 0;
+	unit.assigned_harvesters = 0;
+	unit.ideal_harvesters = 0;
+
+	all_units_.push_back(&unit);
+	switch (alliance) {
+	case Unit::Alliance::Self:
+		own_units_.push_back(&unit);
+		break;
+	case Unit::Alliance::Neutral:
+		neutral_units_.push_back(&unit);
+		break;
+	default:
+		enemy_units_.push_back(&unit);
+		break;
+	}
+	return unit;
+}
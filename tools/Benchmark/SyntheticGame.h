@@ -0,0 +1,53 @@
+#ifndef SYNTHETIC_GAME_H
+#define SYNTHETIC_GAME_H
+
+#include "sc2api/sc2_api.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace sc2;
+
+struct SyntheticGameOptions {
+	int units = 100;           // Our units and enemy units, neutrals come on top
+	int bases = 0;             // 0 picks one base per 100 units
+	int minerals_per_base = 8; // Dense maps have more
+	int geysers_per_base = 2;
+	uint32_t seed = 1;
+};
+
+// A game state built from scratch with the unit mix of a real game: bases with their mineral
+// lines and geysers, drones mining, an army, structures and enemies spread over the map. Enough
+// for the bot's unit queries and analyses to take their real code paths.
+class SyntheticGame {
+  public:
+	explicit SyntheticGame(const SyntheticGameOptions &options);
+
+	const Units &AllUnits() const { return all_units_; }
+	const Units &OwnUnits() const { return own_units_; }
+	const Units &NeutralUnits() const { return neutral_units_; }
+	const Units &EnemyUnits() const { return enemy_units_; }
+	const Point2D &StartLocation() const { return start_location_; }
+	const GameInfo &Info() const { return game_info_; }
+	const std::string &Creep() const { return creep_; } // Packed one bit per tile, like the raw map state
+	const Unit *GetUnit(Tag tag) const;                  // Null for tags this game did not hand out, like ObservationInterface::GetUnit
+
+  private:
+	static const Tag kFirstTag = 0x100000001ull;
+	static const Tag kTagStride = 0x40000ull; // Real tags keep an index in the low bits and a recycle count above
+
+	Unit &AddUnit(Unit::Alliance alliance, UNIT_TYPEID type, const Point2D &pos);
+
+	std::vector<Unit> storage_; // Reserved up front, the unit lists point into it
+	Units all_units_;
+	Units own_units_;
+	Units neutral_units_;
+	Units enemy_units_;
+	Point2D start_location_;
+	GameInfo game_info_;
+	std::string creep_;
+	Tag next_tag_ = kFirstTag;
+};
+
+#endif
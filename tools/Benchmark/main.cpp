@@ -0,0 +1,285 @@
+#include "sc2utils/sc2_arg_parser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+
+#include "BileTargeting.h"
+#include "CreepGrid.h"
+#include "DecisionTrace.h"
+#include "SquadManager.h"
+#include "StepAnalysis.h"
+#include "StepUnits.h"
+#include "SyntheticGame.h"
+#include "ThreadPool.h"
+#include "UnitQueries.h"
+#include "UnitRegistry.h"
+
+// Every allocation in the process goes through these, so each benchmark can report its count
+namespace {
+std::atomic<uint64_t> allocations(0);
+} // namespace
+
+void *operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	void *memory = std::malloc(size ? size : 1);
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+
+namespace {
+const int kGameSizes[] = {10, 50, 200, 500, 1000, 2000};
+const int kRepeats = 5;                             // Best of, to keep scheduler noise out of the baseline
+const std::chrono::milliseconds kMinRunTime(20);    // Per repeat
+const std::chrono::microseconds kGameStepTime(500); // Stands in for the game simulating a step, in the serial and pipelined step rows
+const size_t kTraceRecords = 8192;                  // Half the trace ring, so none are dropped
+const char *const kTraceFile = "BotBenchmark.trace";
+
+struct Result {
+	double nanoseconds; // Per call
+	double allocations; // Per call
+};
+
+template <class Fn> Result Measure(Fn fn) {
+	fn(); // Warm caches and reusable buffers, steady state is what the bot sees every step
+
+	uint64_t calls = 0;
+	uint64_t allocations_before = allocations.load();
+	double best = 0.0;
+	for (int repeat = 0; repeat < kRepeats; ++repeat) {
+		uint64_t repeat_calls = 0;
+		auto start = std::chrono::steady_clock::now();
+		auto elapsed = std::chrono::steady_clock::duration::zero();
+		do {
+			fn();
+			repeat_calls++;
+			elapsed = std::chrono::steady_clock::now() - start;
+		} while (elapsed < kMinRunTime);
+		double nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count() / repeat_calls;
+		best = repeat == 0 ? nanoseconds : std::min(best, nanoseconds);
+		calls += repeat_calls;
+	}
+	return {best, static_cast<double>(allocations.load() - allocations_before) / calls};
+}
+
+void SimulateGameStep() { // Busy, like the game process competing for the cores
+	auto start = std::chrono::steady_clock::now();
+	while (std::chrono::steady_clock::now() - start < kGameStepTime) {
+	}
+}
+
+// Record never blocks, so calling it in a timed loop would fill the ring and time the drop path.
+// Each repeat times half a ring of records on a fresh trace instead, one per unit in turn.
+Result MeasureTraceRecord(const Units &units) {
+	DecisionTrace trace;
+	double best = 0.0;
+	uint64_t allocations_during = 0;
+	for (int repeat = 0; repeat < kRepeats; ++repeat) {
+		trace.Open(kTraceFile);
+		TraceRecord record = {};
+		uint64_t allocations_before = allocations.load();
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < kTraceRecords; ++i) {
+			const Unit *unit = units[i % units.size()];
+			record.game_loop = static_cast<uint32_t>(i);
+			record.unit_tag = unit->tag;
+			record.target_x = unit->pos.x;
+			record.target_y = unit->pos.y;
+			trace.Record(record);
+		}
+		double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kTraceRecords;
+		allocations_during += allocations.load() - allocations_before;
+		best = repeat == 0 ? nanoseconds : std::min(best, nanoseconds);
+		trace.Close();
+	}
+	std::remove(kTraceFile);
+	return {best, static_cast<double>(allocations_during) / (kRepeats * kTraceRecords)};
+}
+
+std::string Key(const std::string &name, int units) { return name + " " + std::to_string(units); }
+
+bool LoadBaseline(const std::string &path, std::map<std::string, Result> &baseline) {
+	std::ifstream file(path);
+	if (!file) {
+		return false;
+	}
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		std::istringstream fields(line);
+		std::string name;
+		int units;
+		Result result;
+		if (fields >> name >> units >> result.nanoseconds >> result.allocations) {
+			baseline[Key(name, units)] = result;
+		}
+	}
+	return true;
+}
+} // namespace
+
+// Times the bot's per-step hot paths on synthetic games of growing size, so paths that grow
+// faster than the unit count show up before they reach a live game. For example,
+//
+// ./BotBenchmark -b baseline.txt        compare against the stored baseline
+// ./BotBenchmark -b baseline.txt -w     store this run as the baseline
+int main(int argc, char *argv[]) {
+	sc2::ArgParser arg_parser(argv[0]);
+	arg_parser.AddOptions({
+		{ "-b", "--Baseline", "Baseline file to compare with (default baseline.txt)", false },
+		{ "-w", "--Write", "Write this run as the new baseline instead of comparing", false },
+		{ "-t", "--Threshold", "Allowed slowdown over the baseline in percent (default 25)", false },
+		{ "-m", "--MaxUnits", "Largest game to run (default 2000)", false }
+		});
+	arg_parser.Parse(argc, argv);
+
+	std::string baseline_path = "baseline.txt";
+	arg_parser.Get("Baseline", baseline_path);
+	std::string value;
+	bool write_baseline = arg_parser.Get("Write", value);
+	double threshold = arg_parser.Get("Threshold", value) ? atof(value.c_str()) / 100.0 : 0.25;
+	int max_units = arg_parser.Get("MaxUnits", value) ? atoi(value.c_str()) : 2000;
+
+	std::map<std::string, Result> baseline;
+	if (!write_baseline && !LoadBaseline(baseline_path, baseline)) {
+		std::cout << "No baseline at " << baseline_path << ", reporting only" << std::endl;
+	}
+
+	ThreadPool pool(ThreadPool::DefaultWorkers());
+	ThreadPool pipeline_pool(std::max(ThreadPool::DefaultWorkers(), 1u)); // Like the bot, background analysis needs a thread of its own
+	std::ostringstream output;
+	output << "# name units ns_per_call allocations_per_call\n";
+	int regressions = 0;
+	std::cout << std::left << std::setw(28) << "benchmark" << std::right << std::setw(7) << "units" << std::setw(14) << "ns/call" << std::setw(10) << "allocs" << std::setw(12)
+	          << "baseline" << std::endl;
+
+	for (int units : kGameSizes) {
+		if (units > max_units) {
+			break;
+		}
+		SyntheticGameOptions options;
+		options.units = units;
+		options.minerals_per_base = 16; // Dense mineral fields
+		SyntheticGame game(options);
+		const Point2D start = game.StartLocation();
+
+		StepSnapshot snapshot;
+		StepAnalysis analysis;
+		StepAnalysis pending_analysis;
+		BuildStepSnapshot(game.AllUnits(), 0, start, snapshot);
+		UnitRegistry registry;
+		CreepGrid creep;
+		creep.Reset(game.Info());
+		std::vector<WorkerTransfer> transfers;
+		StepUnits step_units;
+		BileTargeting bile;
+		std::vector<BileCast> bile_casts;
+		Units ravagers = UnitsOfType(game.OwnUnits(), UNIT_TYPEID::ZERG_RAVAGER);
+		SquadManager squads;
+		for (const auto &unit : game.OwnUnits()) {
+			if (IsCombatUnitType(unit->unit_type)) {
+				squads.Add(unit);
+			}
+		}
+		auto lookup = [&game](Tag tag) { return game.GetUnit(tag); };
+		Units squad_units;
+		AnalyzeTarget(snapshot, analysis.target); // Target selection runs with the other analyses in OnStep
+		uint32_t game_loop = 0;
+
+		auto report = [&](const std::string &name, const Result &result) {
+			output << name << " " << units << " " << result.nanoseconds << " " << result.allocations << "\n";
+			std::cout << std::left << std::setw(28) << name << std::right << std::setw(7) << units << std::setw(14) << std::fixed << std::setprecision(0) << result.nanoseconds
+			          << std::setw(10) << std::setprecision(1) << result.allocations;
+			auto entry = baseline.find(Key(name, units));
+			if (entry != baseline.end()) {
+				double change = result.nanoseconds / entry->second.nanoseconds - 1.0;
+				bool regressed = change > threshold || result.allocations > entry->second.allocations + 0.5;
+				std::cout << std::setw(11) << std::showpos << std::setprecision(0) << change * 100.0 << "%" << std::noshowpos << (regressed ? "  REGRESSION" : "");
+				regressions += regressed ? 1 : 0;
+			}
+			std::cout << std::endl;
+		};
+
+		report("GetUnitsOfType", Measure([&]() { UnitsOfType(game.OwnUnits(), UNIT_TYPEID::ZERG_DRONE); }));
+		report("StepUnitsRefresh", Measure([&]() { step_units.Refresh(game.AllUnits(), ++game_loop); })); // Once per step, then lookups are a binary search
+		report("StepUnitsOfType", Measure([&]() { step_units.OfType(UNIT_TYPEID::ZERG_DRONE); }));
+		report("FindNearestMineralPatch", Measure([&]() { NearestMineralPatch(game.NeutralUnits(), start); }));
+		report("FindNearestVespenseGeyser", Measure([&]() { NearestFreeGeyser(game.NeutralUnits(), game.AllUnits(), start); }));
+		report("BalanceWorkers", Measure([&]() {
+			       AnalyzeSaturation(snapshot, analysis.saturation);
+			       transfers.clear();
+			       PlanWorkerBalance(snapshot, analysis.saturation.oversaturated_bases, analysis.saturation.undersaturated_bases, registry, transfers);
+		       }));
+		report("TryBuildStructurePlacement", Measure([&]() {
+			       AnalyzePlacement(snapshot, analysis.placement);
+			       for (const auto &candidate : analysis.placement.candidates) { // The bot stops at the first spot with creep
+				       if (creep.HasCreepFootprint(candidate, 3)) {
+					       break;
+				       }
+			       }
+		       }));
+		report("AttackWithArmy", Measure([&]() { // Squads keep their members, a step refreshes them and orders the idle ones
+			       squads.Update(lookup);
+			       squads.Order(SquadRole::Main, analysis.target.target, lookup, squad_units);
+		       }));
+		report("CastCorrosiveBile", Measure([&]() { bile.Plan(ravagers, game.EnemyUnits(), 0, bile_casts); })); // Nothing recorded, so every ravager stays ready
+		report("OnStep", Measure([&]() { // The game independent part of a step: snapshot, creep and registry upkeep, parallel analyses
+			       BuildStepSnapshot(game.AllUnits(), ++game_loop, start, snapshot);
+			       creep.Update(game.Creep(), 1);
+			       for (const auto &drone : snapshot.drones) {
+				       registry.Assign(drone.tag, UnitRole::Minerals, NullTag, game_loop);
+			       }
+			       RunStepAnalysis(pool, snapshot, analysis);
+			       transfers.clear();
+			       PlanWorkerBalance(snapshot, analysis.saturation.oversaturated_bases, analysis.saturation.undersaturated_bases, registry, transfers);
+		       }));
+		report("TraceRecord", MeasureTraceRecord(game.OwnUnits())); // Per traced action, compare with OnStep times the actions per step
+		// Whole steps in both modes of the bot on the same game, the pipelined one overlaps the
+		// analysis with the game step and uses results one step old
+		report("SerialStep", Measure([&]() {
+			       BuildStepSnapshot(game.AllUnits(), ++game_loop, start, snapshot);
+			       RunStepAnalysis(pool, snapshot, analysis);
+			       SimulateGameStep();
+		       }));
+		report("PipelinedStep", Measure([&]() {
+			       pipeline_pool.Wait();
+			       std::swap(analysis, pending_analysis);
+			       BuildStepSnapshot(game.AllUnits(), ++game_loop, start, snapshot);
+			       SubmitStepAnalysis(pipeline_pool, snapshot, pending_analysis);
+			       SimulateGameStep();
+		       }));
+		pipeline_pool.Wait(); // The last step's analysis still reads the snapshot
+	}
+
+	if (write_baseline) {
+		std::ofstream file(baseline_path);
+		file << output.str();
+		if (!file) {
+			std::cerr << "Could not write " << baseline_path << std::endl;
+			return 1;
+		}
+		std::cout << "Wrote " << baseline_path << std::endl;
+		return 0;
+	}
+	if (regressions > 0) {
+		std::cout << regressions << " benchmarks slower than the baseline by more than " << threshold * 100.0 << "%" << std::endl;
+		return 1;
+	}
+	return 0;
+}
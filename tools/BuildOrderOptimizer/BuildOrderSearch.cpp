@@ -0,0 +1,253 @@
+#include "BuildOrderSearch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace {
+const int kTournamentSize = 3;
+const int kCrossoverPercent = 30;
+const int kMaxMutations = 3;
+const int kChunkSize = 64; // Candidates claimed per work item, large enough to keep the atomic cold
+const int kSupplyMargin = 2;
+
+uint64_t NextRandom(uint64_t &state) { // splitmix64, cheap and allocation free
+	uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+int RandomBelow(uint64_t &state, int bound) { return static_cast<int>(NextRandom(state) % static_cast<uint64_t>(bound)); }
+
+void Append(Candidate &candidate, BuildOrderItem item) {
+	if (candidate.length < kMaxOrderLength) {
+		candidate.genes[candidate.length++] = item;
+	}
+}
+
+bool BetterThan(const Candidate &a, const Candidate &b) { // Shorter orders win ties
+	if (a.result.fitness != b.result.fitness) {
+		return a.result.fitness < b.result.fitness;
+	}
+	return a.length < b.length;
+}
+} // namespace
+
+BuildOrderSearch::BuildOrderSearch(const EconomyGoal &goal, const SearchOptions &options) : goal_(goal), options_(options) {
+	threads_ = options_.threads > 0 ? options_.threads : static_cast<int>(std::thread::hardware_concurrency());
+	threads_ = std::max(threads_, 1);
+	options_.population = std::max(options_.population, 2);
+	options_.elite = std::min(std::max(options_.elite, 1), options_.population - 1);
+}
+
+template <class Fn> void BuildOrderSearch::ParallelFor(int count, Fn fn) const {
+	std::atomic<int> next_chunk(0);
+	auto worker = [&]() {
+		for (;;) {
+			int begin = next_chunk.fetch_add(kChunkSize);
+			if (begin >= count) {
+				return;
+			}
+			int end = std::min(begin + kChunkSize, count);
+			for (int i = begin; i < end; ++i) {
+				fn(i);
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int t = 1; t < threads_; ++t) {
+		pool.emplace_back(worker);
+	}
+	worker(); // The calling thread works too
+	for (auto &thread : pool) {
+		thread.join();
+	}
+}
+
+Candidate BuildOrderSearch::Run() {
+	std::vector<Candidate> population(options_.population);
+	std::vector<Candidate> next(options_.population);
+
+	SeedPopulation(population);
+	Evaluate(population, 0);
+	for (int generation = 1; generation <= options_.generations; ++generation) {
+		Breed(population, next, generation);
+		Evaluate(next, options_.elite); // Elites were already simulated, results are deterministic
+		population.swap(next);
+
+		if (generation % 20 == 0 || generation == options_.generations) {
+			const Candidate &best = population.front();
+			std::cout << "generation " << generation << ": best " << best.result.fitness << (best.result.goal_reached ? "s" : "s (goal not reached)") << ", "
+			          << best.length << " items" << std::endl;
+		}
+	}
+	return population.front();
+}
+
+void BuildOrderSearch::SeedPopulation(std::vector<Candidate> &population) const {
+	// Hand-rolled opener that reaches the goal tech, then round-robins the goal units. It is
+	// slow but valid, and mutated copies of it make up the first generation.
+	Candidate seed;
+	seed.length = 0;
+	int supply = 12;
+	int cap = 14;
+	auto add = [&](BuildOrderItem item) {
+		const ItemSpec &spec = GetItemSpec(item);
+		if (spec.supply > 0 && supply + spec.supply > cap - kSupplyMargin) {
+			Append(seed, BuildOrderItem::Overlord);
+			cap += 8;
+		}
+		Append(seed, item);
+		supply += spec.supply - (spec.producer == Producer::Drone ? 1 : 0);
+	};
+
+	bool needed[kItemCount] = {};
+	for (int i = 0; i < kItemCount; ++i) {
+		if (goal_.count[i] <= 0) {
+			continue;
+		}
+		for (BuildOrderItem tech = GetItemSpec(static_cast<BuildOrderItem>(i)).requirement; tech != BuildOrderItem::Count; tech = GetItemSpec(tech).requirement) {
+			needed[static_cast<int>(tech)] = true;
+		}
+	}
+	bool needs_gas = false;
+	for (int i = 0; i < kItemCount; ++i) {
+		if ((goal_.count[i] > 0 || needed[i]) && GetItemSpec(static_cast<BuildOrderItem>(i)).vespene > 0) {
+			needs_gas = true;
+		}
+	}
+
+	for (int i = 0; i < 4; ++i) {
+		add(BuildOrderItem::Drone);
+	}
+	for (int i = 1; i < goal_.count[static_cast<int>(BuildOrderItem::Hatchery)]; ++i) {
+		add(BuildOrderItem::Hatchery);
+	}
+	if (needs_gas) {
+		add(BuildOrderItem::Extractor);
+	}
+	const BuildOrderItem tech_order[] = {BuildOrderItem::SpawningPool, BuildOrderItem::RoachWarren, BuildOrderItem::Lair, BuildOrderItem::HydraliskDen, BuildOrderItem::Spire};
+	for (BuildOrderItem tech : tech_order) {
+		if (needed[static_cast<int>(tech)] || goal_.count[static_cast<int>(tech)] > 0) {
+			add(tech);
+		}
+	}
+
+	int remaining[kItemCount];
+	for (int i = 0; i < kItemCount; ++i) {
+		remaining[i] = goal_.count[i];
+	}
+	remaining[static_cast<int>(BuildOrderItem::Drone)] -= supply;
+	for (bool added = true; added && seed.length < kMaxOrderLength;) {
+		added = false;
+		for (int i = 0; i < kItemCount; ++i) {
+			BuildOrderItem item = static_cast<BuildOrderItem>(i);
+			if (remaining[i] > 0 && GetItemSpec(item).producer != Producer::Drone && item != BuildOrderItem::Lair) {
+				add(item);
+				remaining[i] -= GetItemSpec(item).yield;
+				added = true;
+			}
+		}
+	}
+
+	population[0] = seed;
+	ParallelFor(static_cast<int>(population.size()) - 1, [&](int i) {
+		Candidate &candidate = population[i + 1];
+		candidate = seed;
+		uint64_t rng = options_.seed ^ (static_cast<uint64_t>(i + 1) << 20);
+		for (int m = RandomBelow(rng, 2 * kMaxMutations) + 1; m > 0; --m) {
+			Mutate(candidate, rng);
+		}
+	});
+}
+
+void BuildOrderSearch::Evaluate(std::vector<Candidate> &population, int first) {
+	int count = static_cast<int>(population.size()) - first;
+	ParallelFor(count, [&](int i) {
+		Candidate &candidate = population[first + i];
+		candidate.result = EconomySimulator::Run(candidate.genes, candidate.length, goal_);
+	});
+	evaluations_ += static_cast<uint64_t>(count);
+	std::stable_sort(population.begin(), population.end(), BetterThan);
+}
+
+void BuildOrderSearch::Breed(const std::vector<Candidate> &parents, std::vector<Candidate> &children, int generation) const {
+	std::copy(parents.begin(), parents.begin() + options_.elite, children.begin());
+
+	int count = static_cast<int>(children.size()) - options_.elite;
+	ParallelFor(count, [&](int i) {
+		// Each child owns its random stream, so the result does not depend on which thread bred it
+		uint64_t rng = options_.seed ^ (static_cast<uint64_t>(generation) << 40) ^ (static_cast<uint64_t>(i) << 8);
+		auto tournament = [&]() -> const Candidate & {
+			int best = RandomBelow(rng, static_cast<int>(parents.size()));
+			for (int t = 1; t < kTournamentSize; ++t) {
+				best = std::min(best, RandomBelow(rng, static_cast<int>(parents.size()))); // Parents are sorted, lower index is fitter
+			}
+			return parents[best];
+		};
+
+		Candidate &child = children[options_.elite + i];
+		const Candidate &mother = tournament();
+		if (RandomBelow(rng, 100) < kCrossoverPercent) { // One-point crossover
+			const Candidate &father = tournament();
+			int cut_mother = RandomBelow(rng, mother.length + 1);
+			int cut_father = RandomBelow(rng, father.length + 1);
+			child.length = 0;
+			for (int g = 0; g < cut_mother; ++g) {
+				Append(child, mother.genes[g]);
+			}
+			for (int g = cut_father; g < father.length; ++g) {
+				Append(child, father.genes[g]);
+			}
+		} else {
+			child = mother;
+		}
+
+		for (int m = RandomBelow(rng, kMaxMutations) + 1; m > 0; --m) {
+			Mutate(child, rng);
+		}
+	});
+}
+
+void BuildOrderSearch::Mutate(Candidate &candidate, uint64_t &rng) const {
+	BuildOrderItem item = static_cast<BuildOrderItem>(RandomBelow(rng, kItemCount));
+	int length = candidate.length;
+	switch (RandomBelow(rng, 4)) {
+	case 0: { // Insert
+		if (length >= kMaxOrderLength) {
+			return;
+		}
+		int at = RandomBelow(rng, length + 1);
+		std::copy_backward(candidate.genes + at, candidate.genes + length, candidate.genes + length + 1);
+		candidate.genes[at] = item;
+		candidate.length++;
+		break;
+	}
+	case 1: { // Delete
+		if (length == 0) {
+			return;
+		}
+		int at = RandomBelow(rng, length);
+		std::copy(candidate.genes + at + 1, candidate.genes + length, candidate.genes + at);
+		candidate.length--;
+		break;
+	}
+	case 2: { // Swap neighbours
+		if (length < 2) {
+			return;
+		}
+		int at = RandomBelow(rng, length - 1);
+		std::swap(candidate.genes[at], candidate.genes[at + 1]);
+		break;
+	}
+	default: // Replace
+		if (length == 0) {
+			return;
+		}
+		candidate.genes[RandomBelow(rng, length)] = item;
+		break;
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef BUILD_ORDER_SEARCH_H
+#define BUILD_ORDER_SEARCH_H
+
+#include "EconomySimulator.h"
+
+#include <cstdint>
+#include <vector>
+
+struct Candidate {
+	BuildOrderItem genes[kMaxOrderLength];
+	int length;
+	SimulationResult result;
+};
+
+struct SearchOptions {
+	int population = 4096;
+	int generations = 200;
+	int elite = 64;      // Best candidates copied unchanged into the next generation
+	int threads = 0;     // 0 uses every hardware thread
+	uint32_t seed = 350; // Same seed and options give the same result on any thread count
+};
+
+// Evolutionary search over build orders. Every generation is evaluated in parallel across threads,
+// each evaluation is a single allocation-free EconomySimulator run.
+class BuildOrderSearch {
+  public:
+	BuildOrderSearch(const EconomyGoal &goal, const SearchOptions &options);
+
+	Candidate Run();
+	uint64_t Evaluations() const { return evaluations_; }
+
+  private:
+	void SeedPopulation(std::vector<Candidate> &population) const;
+	void Evaluate(std::vector<Candidate> &population, int first);
+	void Breed(const std::vector<Candidate> &parents, std::vector<Candidate> &children, int generation) const;
+	void Mutate(Candidate &candidate, uint64_t &rng) const;
+
+	template <class Fn> void ParallelFor(int count, Fn fn) const;
+
+	EconomyGoal goal_;
+	SearchOptions options_;
+	int threads_;
+	uint64_t evaluations_ = 0;
+};
+
+#endif
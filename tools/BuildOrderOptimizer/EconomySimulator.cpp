@@ -0,0 +1,299 @@
+#include "EconomySimulator.h"
+
+#include "ZergData.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+// Costs, supply and build times come from the bot's table, build times are faster-speed game
+// seconds. Zergling orders make a pair for the cost and supply of one order.
+constexpr ItemSpec Spec(UNIT_TYPEID type, int yield, Producer producer, BuildOrderItem requirement) {
+	return {UnitData(type).minerals, UnitData(type).vespene, static_cast<int>(UnitData(type).supply), static_cast<int>(UnitData(type).build_time), yield, producer, requirement};
+}
+
+constexpr ItemSpec kItemSpecs[] = {
+    Spec(UNIT_TYPEID::ZERG_DRONE, 1, Producer::Larva, BuildOrderItem::Count),
+    Spec(UNIT_TYPEID::ZERG_OVERLORD, 1, Producer::Larva, BuildOrderItem::Count),
+    Spec(UNIT_TYPEID::ZERG_ZERGLING, 2, Producer::Larva, BuildOrderItem::SpawningPool),
+    Spec(UNIT_TYPEID::ZERG_QUEEN, 1, Producer::Hatchery, BuildOrderItem::SpawningPool),
+    Spec(UNIT_TYPEID::ZERG_ROACH, 1, Producer::Larva, BuildOrderItem::RoachWarren),
+    Spec(UNIT_TYPEID::ZERG_HYDRALISK, 1, Producer::Larva, BuildOrderItem::HydraliskDen),
+    Spec(UNIT_TYPEID::ZERG_MUTALISK, 1, Producer::Larva, BuildOrderItem::Spire),
+    Spec(UNIT_TYPEID::ZERG_HATCHERY, 1, Producer::Drone, BuildOrderItem::Count),
+    Spec(UNIT_TYPEID::ZERG_EXTRACTOR, 1, Producer::Drone, BuildOrderItem::Count),
+    Spec(UNIT_TYPEID::ZERG_SPAWNINGPOOL, 1, Producer::Drone, BuildOrderItem::Count),
+    Spec(UNIT_TYPEID::ZERG_ROACHWARREN, 1, Producer::Drone, BuildOrderItem::SpawningPool),
+    Spec(UNIT_TYPEID::ZERG_LAIR, 1, Producer::Morph, BuildOrderItem::SpawningPool),
+    Spec(UNIT_TYPEID::ZERG_HYDRALISKDEN, 1, Producer::Drone, BuildOrderItem::Lair),
+    Spec(UNIT_TYPEID::ZERG_SPIRE, 1, Producer::Drone, BuildOrderItem::Lair),
+};
+static_assert(sizeof(kItemSpecs) / sizeof(kItemSpecs[0]) == static_cast<size_t>(kItemCount), "Item specs out of sync with BuildOrderItem");
+
+const float kMineralRatePerDrone = 0.94f;     // First two drones per patch, 8 patches per base
+const float kOversaturatedMineralRate = 0.35f; // Third drone per patch
+const float kVespeneRatePerDrone = 0.89f;      // Three drones per extractor
+const int kEfficientDronesPerBase = 16;
+const int kOversaturatedDronesPerBase = 8;
+const int kDronesPerExtractor = 3;
+const int kExtractorsPerBase = 2;
+
+const int kLarvaInterval = 11; // Seconds per natural larva
+const int kNaturalLarvaCap = 3;
+const int kMaxLarva = 19;
+const int kInjectDuration = 29;
+const int kInjectLarva = 3;
+const float kInjectEnergy = 25.0f;
+const float kQueenStartEnergy = 25.0f;
+const float kQueenEnergyRegen = 0.7875f;
+const float kQueenMaxEnergy = 200.0f;
+
+const int kHatcherySupply = 6;
+const int kOverlordSupply = 8;
+const int kMaxSupply = 200;
+
+const float kShortfallPenalty = 20.0f; // Seconds charged per missing unit when the goal is not reached
+
+bool IsUniqueStructure(BuildOrderItem item) {
+	return item == BuildOrderItem::SpawningPool || item == BuildOrderItem::RoachWarren || item == BuildOrderItem::Lair || item == BuildOrderItem::HydraliskDen ||
+	       item == BuildOrderItem::Spire;
+}
+
+int Index(BuildOrderItem item) { return static_cast<int>(item); }
+} // namespace
+
+const ItemSpec &GetItemSpec(BuildOrderItem item) { return kItemSpecs[Index(item)]; }
+
+void EconomySimulator::InitialState(EconomyState &state) {
+	std::memset(&state, 0, sizeof(state));
+	state.minerals = 50.0f;
+	state.supply_used = 12;
+	state.supply_cap = kHatcherySupply + kOverlordSupply;
+	state.mineral_drones = 12;
+	state.hatchery_count = 1;
+	state.larva[0] = 3;
+	state.count[Index(BuildOrderItem::Drone)] = 12;
+	state.count[Index(BuildOrderItem::Overlord)] = 1;
+	state.count[Index(BuildOrderItem::Hatchery)] = 1;
+}
+
+SimulationResult EconomySimulator::Run(const BuildOrderItem *order, int length, const EconomyGoal &goal, BuildOrderStep *trace) {
+	EconomyState state;
+	InitialState(state);
+
+	SimulationResult result = {0, false, 0, 0, 0.0f};
+	int next = 0;
+	for (;;) {
+		while (next < length) { // Start as many items as possible this second
+			int supply = state.supply_used;
+			StartResult start = TryStart(state, order[next]);
+			if (start == StartResult::Wait) {
+				break;
+			}
+			if (start == StartResult::Started) {
+				if (trace && result.steps_started < kMaxOrderLength) {
+					trace[result.steps_started] = {supply, order[next]};
+				}
+				result.steps_started++;
+			} else {
+				result.steps_skipped++;
+			}
+			next++;
+		}
+
+		if (GoalReached(state, goal)) {
+			result.goal_reached = true;
+			break;
+		}
+		if (state.time >= goal.time_limit || (next >= length && state.pending_size == 0)) { // Out of time or nothing left to wait for
+			break;
+		}
+		AdvanceOneSecond(state);
+	}
+
+	result.time = state.time;
+	result.fitness = result.goal_reached ? static_cast<float>(state.time) : static_cast<float>(goal.time_limit) + Shortfall(state, goal) * kShortfallPenalty;
+	return result;
+}
+
+void EconomySimulator::AdvanceOneSecond(EconomyState &state) {
+	++state.time;
+
+	int bases = state.hatchery_count;
+	int efficient = std::min(state.mineral_drones, bases * kEfficientDronesPerBase);
+	int oversaturated = std::min(state.mineral_drones - efficient, bases * kOversaturatedDronesPerBase);
+	int gas_workers = std::min(state.gas_drones, state.count[Index(BuildOrderItem::Extractor)] * kDronesPerExtractor);
+	state.minerals += efficient * kMineralRatePerDrone + oversaturated * kOversaturatedMineralRate;
+	state.vespene += gas_workers * kVespeneRatePerDrone;
+
+	int tracked_hatcheries = std::min(bases, kMaxHatcheries);
+	for (int h = 0; h < tracked_hatcheries; ++h) {
+		if (state.larva[h] < kNaturalLarvaCap) {
+			if (++state.larva_timer[h] >= kLarvaInterval) {
+				state.larva[h]++;
+				state.larva_timer[h] = 0;
+			}
+		} else {
+			state.larva_timer[h] = 0;
+		}
+		if (state.inject_end[h] != 0 && state.time >= state.inject_end[h]) {
+			state.larva[h] = std::min(state.larva[h] + kInjectLarva, kMaxLarva);
+			state.inject_end[h] = 0;
+		}
+	}
+
+	int tracked_queens = std::min(state.queen_count, kMaxQueens);
+	for (int q = 0; q < tracked_queens; ++q) { // Each queen injects the hatchery it is bound to
+		state.queen_energy[q] = std::min(state.queen_energy[q] + kQueenEnergyRegen, kQueenMaxEnergy);
+		int h = q % tracked_hatcheries;
+		if (state.queen_energy[q] >= kInjectEnergy && state.inject_end[h] == 0) {
+			state.queen_energy[q] -= kInjectEnergy;
+			state.inject_end[h] = state.time + kInjectDuration;
+		}
+	}
+
+	for (int i = 0; i < state.pending_size;) {
+		if (state.pending_items[i].finish_time <= state.time) {
+			BuildOrderItem item = state.pending_items[i].item;
+			state.pending_items[i] = state.pending_items[--state.pending_size]; // Swap remove, order does not matter
+			CompleteItem(state, item);
+		} else {
+			++i;
+		}
+	}
+}
+
+void EconomySimulator::CompleteItem(EconomyState &state, BuildOrderItem item) {
+	const ItemSpec &spec = GetItemSpec(item);
+	state.count[Index(item)] += spec.yield;
+	state.pending[Index(item)]--;
+
+	switch (item) {
+	case BuildOrderItem::Drone:
+		state.mineral_drones++;
+		break;
+	case BuildOrderItem::Overlord:
+		state.supply_cap += kOverlordSupply;
+		break;
+	case BuildOrderItem::Hatchery:
+		state.supply_cap += kHatcherySupply;
+		state.hatchery_count++;
+		break;
+	case BuildOrderItem::Extractor: { // Saturate new extractors straight from the mineral line
+		int moved = std::min(kDronesPerExtractor, state.mineral_drones);
+		state.mineral_drones -= moved;
+		state.gas_drones += moved;
+		break;
+	}
+	case BuildOrderItem::Queen:
+		state.hatchery_queue--;
+		if (state.queen_count < kMaxQueens) {
+			state.queen_energy[state.queen_count] = kQueenStartEnergy;
+		}
+		state.queen_count++;
+		break;
+	default:
+		break;
+	}
+}
+
+EconomySimulator::StartResult EconomySimulator::TryStart(EconomyState &state, BuildOrderItem item) {
+	const ItemSpec &spec = GetItemSpec(item);
+	int index = Index(item);
+
+	if (spec.requirement != BuildOrderItem::Count && state.count[Index(spec.requirement)] == 0) { // Wait for tech, or drop the item if it never comes
+		return state.pending[Index(spec.requirement)] > 0 ? StartResult::Wait : StartResult::Skip;
+	}
+	if (IsUniqueStructure(item) && state.count[index] + state.pending[index] > 0) {
+		return StartResult::Skip;
+	}
+	if (item == BuildOrderItem::Extractor) {
+		int bases = state.count[Index(BuildOrderItem::Hatchery)] + state.pending[Index(BuildOrderItem::Hatchery)];
+		if (state.count[index] + state.pending[index] >= bases * kExtractorsPerBase) {
+			return StartResult::Skip;
+		}
+	}
+	if (spec.supply > 0 && state.supply_used + spec.supply > std::min(state.supply_cap, kMaxSupply)) {
+		bool supply_coming = state.pending[Index(BuildOrderItem::Overlord)] > 0 || state.pending[Index(BuildOrderItem::Hatchery)] > 0;
+		return supply_coming && state.supply_cap < kMaxSupply ? StartResult::Wait : StartResult::Skip;
+	}
+	if (state.pending_size >= kMaxPending) {
+		return StartResult::Wait;
+	}
+	if (spec.vespene > state.vespene && state.gas_drones == 0 && state.pending[Index(BuildOrderItem::Extractor)] == 0) { // No gas income will ever arrive
+		return StartResult::Skip;
+	}
+
+	int larva_hatchery = 0;
+	switch (spec.producer) {
+	case Producer::Larva: {
+		int tracked_hatcheries = std::min(state.hatchery_count, kMaxHatcheries);
+		for (int h = 1; h < tracked_hatcheries; ++h) { // Take larva from the hatchery with the most
+			if (state.larva[h] > state.larva[larva_hatchery]) {
+				larva_hatchery = h;
+			}
+		}
+		if (state.larva[larva_hatchery] == 0) {
+			return StartResult::Wait;
+		}
+		break;
+	}
+	case Producer::Drone:
+		if (state.mineral_drones == 0) {
+			return state.pending[Index(BuildOrderItem::Drone)] > 0 ? StartResult::Wait : StartResult::Skip;
+		}
+		break;
+	case Producer::Hatchery:
+		if (state.hatchery_queue >= state.hatchery_count) {
+			return StartResult::Wait;
+		}
+		break;
+	case Producer::Morph:
+		break;
+	}
+
+	if (state.minerals < spec.minerals || state.vespene < spec.vespene) {
+		return StartResult::Wait;
+	}
+
+	state.minerals -= spec.minerals;
+	state.vespene -= spec.vespene;
+	state.supply_used += spec.supply;
+	switch (spec.producer) {
+	case Producer::Larva:
+		state.larva[larva_hatchery]--;
+		break;
+	case Producer::Drone:
+		state.mineral_drones--;
+		state.supply_used--;
+		state.count[Index(BuildOrderItem::Drone)]--;
+		break;
+	case Producer::Hatchery:
+		state.hatchery_queue++;
+		break;
+	case Producer::Morph:
+		break;
+	}
+
+	state.pending[index]++;
+	state.pending_items[state.pending_size++] = {state.time + spec.build_time, item};
+	return StartResult::Started;
+}
+
+bool EconomySimulator::GoalReached(const EconomyState &state, const EconomyGoal &goal) {
+	for (int i = 0; i < kItemCount; ++i) {
+		if (state.count[i] < goal.count[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+float EconomySimulator::Shortfall(const EconomyState &state, const EconomyGoal &goal) {
+	float shortfall = 0.0f;
+	for (int i = 0; i < kItemCount; ++i) { // Units still in production count half, so the search sees progress
+		float missing = goal.count[i] - state.count[i] - 0.5f * state.pending[i] * GetItemSpec(static_cast<BuildOrderItem>(i)).yield;
+		shortfall += std::max(missing, 0.0f);
+	}
+	return shortfall;
+}
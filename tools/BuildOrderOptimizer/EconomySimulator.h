@@ -0,0 +1,96 @@
+#ifndef ECONOMY_SIMULATOR_H
+#define ECONOMY_SIMULATOR_H
+
+#include "BuildOrder.h"
+
+#include <cstdint>
+
+// Fixed capacities keep the simulator state a flat POD that lives on the stack, so evaluating
+// a candidate order never touches the heap.
+const int kMaxHatcheries = 8;
+const int kMaxQueens = 8;
+const int kMaxPending = 64;
+const int kMaxOrderLength = 64;
+const int kItemCount = static_cast<int>(BuildOrderItem::Count);
+
+// How an item is produced
+enum class Producer : uint8_t {
+	Larva,    // Consumes a larva
+	Drone,    // Consumes a drone (structures)
+	Hatchery, // Trained from a hatchery without consuming it (queens)
+	Morph,    // Morphs an existing hatchery in place (lair)
+};
+
+struct ItemSpec {
+	int minerals;
+	int vespene;
+	int supply;                 // Supply used per item (zerglings come in pairs and use 1)
+	int build_time;             // Game seconds on faster speed
+	int yield;                  // Units produced per item
+	Producer producer;
+	BuildOrderItem requirement; // Tech requirement, Count when none
+};
+
+const ItemSpec &GetItemSpec(BuildOrderItem item);
+
+// Target composition, counted on completed units
+struct EconomyGoal {
+	int count[kItemCount];
+	int time_limit; // Give up after this many game seconds
+};
+
+struct PendingItem {
+	int finish_time;
+	BuildOrderItem item;
+};
+
+struct EconomyState {
+	int time; // Game seconds since game start
+	float minerals;
+	float vespene;
+	int supply_used;
+	int supply_cap;
+	int mineral_drones;
+	int gas_drones;
+	int hatchery_count; // Completed hatcheries, the first kMaxHatcheries are tracked below
+	int larva[kMaxHatcheries];
+	int larva_timer[kMaxHatcheries];
+	int inject_end[kMaxHatcheries]; // Time the pending inject pops, 0 when none
+	int queen_count;
+	float queen_energy[kMaxQueens];
+	int hatchery_queue; // Queens in training across all hatcheries
+	int count[kItemCount];   // Completed
+	int pending[kItemCount]; // In production
+	int pending_size;
+	PendingItem pending_items[kMaxPending];
+};
+
+struct SimulationResult {
+	int time;          // Time the goal was reached, or the time simulation stopped
+	bool goal_reached;
+	int steps_started; // Items from the order that were started
+	int steps_skipped; // Items dropped because they could never start
+	float fitness;     // Lower is better
+};
+
+// Simulates a Zerg opener on the macro level: mining, larva, injects, supply and build times.
+// The order is executed greedily, each item starts as soon as it is affordable.
+class EconomySimulator {
+  public:
+	static void InitialState(EconomyState &state);
+
+	// Runs the order until the goal is reached or the time limit runs out. If trace is not null it
+	// receives the started steps (with supply at start time), up to kMaxOrderLength entries.
+	static SimulationResult Run(const BuildOrderItem *order, int length, const EconomyGoal &goal, BuildOrderStep *trace = nullptr);
+
+  private:
+	enum class StartResult { Started, Wait, Skip };
+
+	static void AdvanceOneSecond(EconomyState &state);
+	static void CompleteItem(EconomyState &state, BuildOrderItem item);
+	static StartResult TryStart(EconomyState &state, BuildOrderItem item);
+	static bool GoalReached(const EconomyState &state, const EconomyGoal &goal);
+	static float Shortfall(const EconomyState &state, const EconomyGoal &goal);
+};
+
+#endif
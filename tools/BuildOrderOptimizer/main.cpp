@@ -0,0 +1,86 @@
+#include "sc2utils/sc2_arg_parser.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "BuildOrder.h"
+#include "BuildOrderSearch.h"
+#include "EconomySimulator.h"
+
+// Offline build order optimizer. Searches for the order that reaches a target composition fastest
+// and writes it in the BuildOrder.txt format the bot loads at game start. For example,
+//
+// ./BuildOrderOptimizer -w 32 -q 2 -b 2 -r 8 -o BuildOrder.txt
+int main(int argc, char *argv[]) {
+	sc2::ArgParser arg_parser(argv[0]);
+	arg_parser.AddOptions({
+		{ "-w", "--Workers", "Target drone count", false },
+		{ "-z", "--Zerglings", "Target zergling count", false },
+		{ "-r", "--Roaches", "Target roach count", false },
+		{ "-y", "--Hydralisks", "Target hydralisk count", false },
+		{ "-u", "--Mutalisks", "Target mutalisk count", false },
+		{ "-q", "--Queens", "Target queen count", false },
+		{ "-b", "--Bases", "Target hatchery count", false },
+		{ "-l", "--TimeLimit", "Game seconds to search within (default 600)", false },
+		{ "-p", "--Population", "Candidates per generation (default 4096)", false },
+		{ "-n", "--Generations", "Number of generations (default 200)", false },
+		{ "-t", "--Threads", "Worker threads (default all cores)", false },
+		{ "-s", "--Seed", "Random seed", false },
+		{ "-o", "--Output", "Build order file to write (default BuildOrder.txt)", false }
+		});
+	arg_parser.Parse(argc, argv);
+
+	auto get_int = [&arg_parser](const std::string &name, int fallback) {
+		std::string value;
+		return arg_parser.Get(name, value) ? atoi(value.c_str()) : fallback;
+	};
+
+	EconomyGoal goal = {};
+	goal.count[static_cast<int>(BuildOrderItem::Drone)] = get_int("Workers", 32);
+	goal.count[static_cast<int>(BuildOrderItem::Zergling)] = get_int("Zerglings", 0);
+	goal.count[static_cast<int>(BuildOrderItem::Roach)] = get_int("Roaches", 0);
+	goal.count[static_cast<int>(BuildOrderItem::Hydralisk)] = get_int("Hydralisks", 0);
+	goal.count[static_cast<int>(BuildOrderItem::Mutalisk)] = get_int("Mutalisks", 0);
+	goal.count[static_cast<int>(BuildOrderItem::Queen)] = get_int("Queens", 2);
+	goal.count[static_cast<int>(BuildOrderItem::Hatchery)] = get_int("Bases", 2);
+	goal.time_limit = get_int("TimeLimit", 600);
+
+	SearchOptions options;
+	options.population = get_int("Population", options.population);
+	options.generations = get_int("Generations", options.generations);
+	options.threads = get_int("Threads", options.threads);
+	options.seed = static_cast<uint32_t>(get_int("Seed", static_cast<int>(options.seed)));
+
+	std::string output = "BuildOrder.txt";
+	arg_parser.Get("Output", output);
+
+	BuildOrderSearch search(goal, options);
+	auto start = std::chrono::steady_clock::now();
+	Candidate best = search.Run();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << search.Evaluations() << " orders simulated in " << seconds << "s (" << static_cast<uint64_t>(search.Evaluations() / seconds) << " per second)" << std::endl;
+	if (!best.result.goal_reached) {
+		std::cout << "Goal not reached within " << goal.time_limit << "s, writing the closest order found" << std::endl;
+	}
+
+	BuildOrderStep trace[kMaxOrderLength];
+	SimulationResult result = EconomySimulator::Run(best.genes, best.length, goal, trace);
+	std::vector<BuildOrderStep> steps(trace, trace + result.steps_started);
+
+	std::ostringstream header;
+	header << "Generated by BuildOrderOptimizer\n";
+	header << "Goal " << (result.goal_reached ? "reached" : "not reached") << " at " << result.time / 60 << ":" << (result.time % 60 < 10 ? "0" : "") << result.time % 60
+	       << " game time";
+	if (!SaveBuildOrder(output, steps, header.str())) {
+		std::cerr << "Could not write " << output << std::endl;
+		return 1;
+	}
+	for (const auto &step : steps) {
+		std::cout << step.supply << " " << BuildOrderItemName(step.item) << std::endl;
+	}
+	std::cout << "Wrote " << output << std::endl;
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include "sc2api/sc2_typeenums.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "DecisionTrace.h"
+
+// Decodes a decision trace written by the bot (--Trace) to text, one line per record. For example,
+//
+// ./TraceReader trace.bin > trace.txt
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <trace file>" << std::endl;
+		return 1;
+	}
+
+	std::FILE *file = std::fopen(argv[1], "rb");
+	if (!file) {
+		std::cerr << "Could not open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	TraceFileHeader header;
+	if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, "SC2T", 4) != 0) {
+		std::cerr << argv[1] << " is not a decision trace" << std::endl;
+		std::fclose(file);
+		return 1;
+	}
+	if (header.version != kTraceFileVersion || header.record_size != sizeof(TraceRecord)) {
+		std::cerr << "Unsupported trace version " << header.version << " with " << header.record_size << " byte records" << std::endl;
+		std::fclose(file);
+		return 1;
+	}
+
+	TraceRecord record;
+	size_t records = 0;
+	size_t steps = 0;
+	uint64_t step_micros = 0;
+	while (std::fread(&record, sizeof(record), 1, file) == 1) {
+		++records;
+		if (record.source == static_cast<uint8_t>(TraceSource::Step)) {
+			++steps;
+			step_micros += record.step_micros;
+			std::printf("%8u  step end      %6uus  minerals %5d  gas %5d  supply %3u/%3u\n", record.game_loop, record.step_micros, record.minerals, record.vespene,
+			            record.supply_used, record.supply_cap);
+			continue;
+		}
+		std::printf("%8u  +%6uus  %-26s %-16s %-32s unit %llx at (%.1f, %.1f)  minerals %5d  gas %5d  supply %3u/%3u\n", record.game_loop, record.step_micros,
+		            TraceSourceName(record.source), TraceReasonName(record.reason), sc2::AbilityTypeToName(sc2::AbilityID(record.ability_id)),
+		            static_cast<unsigned long long>(record.unit_tag), record.target_x, record.target_y, record.minerals, record.vespene, record.supply_used, record.supply_cap);
+	}
+	std::fclose(file);
+
+	std::cerr << records << " records, " << steps << " steps";
+	if (steps > 0) {
+		std::cerr << ", " << step_micros / steps << "us per step on average";
+	}
+	std::cerr << std::endl;
+	return 0;
+}